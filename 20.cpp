@@ -144,3 +144,257 @@ int main() {
     std::cout << A << "\n" << B << "\n";
 }
 
+
+
+// ===========================
+
+// Посмотрим внимательнее, сколько работы делает выражение D = A + B + C.
+// Сначала operator + копирует A во временную матрицу и прибавляет к ней B (первый проход по памяти),
+// затем копирует результат во вторую временную матрицу и прибавляет C (второй проход),
+// и только потом результат копируется в D. Промежуточные матрицы нам совершенно не нужны:
+// каждый элемент D(i, j) можно было бы сразу посчитать как A(i, j) + B(i, j) + C(i, j).
+
+// Добиться этого можно с помощью приёма, который называется "шаблоны выражений" (expression templates).
+// Идея такая: operator + ничего не вычисляет, а лишь возвращает лёгкий объект, который помнит свои операнды
+// и умеет по запросу вычислить один элемент суммы. Тип этого объекта кодирует всё дерево выражения,
+// например, Sum<Sum<Matrix, Matrix>, Matrix>. Настоящие вычисления происходят только при присваивании в матрицу -
+// одним циклом, с записью прямо в матрицу-получатель.
+
+#include <cstddef>
+#include <iostream>
+
+// Базовый класс для всех выражений. Параметр E - это сам класс-наследник ("странно рекурсивный шаблон", CRTP).
+// Благодаря ему функции, принимающие MatrixExpression, знают точный тип выражения, и компилятор может всё встроить.
+template <typename T, int N, typename E>
+class MatrixExpression {
+public:
+    const E& get() const {
+        return static_cast<const E&>(*this);
+    }
+
+    T operator() (size_t i, size_t j) const {
+        return get().at(i, j);
+    }
+};
+
+template <typename T, int N>
+class Matrix;
+
+// Матрицы внутри выражения храним по ссылке, а промежуточные выражения - по значению.
+// Иначе в выражении A + B + C внутренний объект A + B был бы временным, и ссылка на него могла бы "протухнуть".
+template <typename E>
+struct ExpressionOperand {
+    typedef const E type;
+};
+
+template <typename T, int N>
+struct ExpressionOperand<Matrix<T, N>> {
+    typedef const Matrix<T, N>& type;
+};
+
+struct Plus {
+    template <typename T>
+    static T apply(const T& a, const T& b) {
+        return a + b;
+    }
+};
+
+struct Minus {
+    template <typename T>
+    static T apply(const T& a, const T& b) {
+        return a - b;
+    }
+};
+
+template <typename T, int N, typename L, typename R, typename Op>
+class BinaryExpression: public MatrixExpression<T, N, BinaryExpression<T, N, L, R, Op>> {
+private:
+    typename ExpressionOperand<L>::type left;
+    typename ExpressionOperand<R>::type right;
+public:
+    BinaryExpression(const L& l, const R& r): left(l), right(r) {
+    }
+
+    T at(size_t i, size_t j) const {
+        return Op::apply(left.at(i, j), right.at(i, j));
+    }
+};
+
+template <typename T, int N, typename E>
+class ScaledExpression: public MatrixExpression<T, N, ScaledExpression<T, N, E>> {
+private:
+    T lambda;
+    typename ExpressionOperand<E>::type expr;
+public:
+    ScaledExpression(const T& l, const E& e): lambda(l), expr(e) {
+    }
+
+    T at(size_t i, size_t j) const {
+        return lambda * expr.at(i, j);
+    }
+};
+
+template <typename T, int N>
+class Matrix: public MatrixExpression<T, N, Matrix<T, N>> {
+private:
+    T data[N][N];
+
+public:
+    Matrix(const T& lambda = 0) {
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] = (i == j) ? lambda : 0;
+    }
+
+    // Вот здесь выражение наконец вычисляется: один проход, никаких временных матриц
+    template <typename E>
+    Matrix(const MatrixExpression<T, N, E>& expr) {
+        const E& e = expr.get();
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] = e.at(i, j);
+    }
+
+    // Поэлементные выражения безопасны даже тогда, когда в правой части встречается сама матрица (A = A + B):
+    // элемент (i, j) результата зависит только от элементов (i, j) операндов.
+    template <typename E>
+    Matrix& operator = (const MatrixExpression<T, N, E>& expr) {
+        const E& e = expr.get();
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] = e.at(i, j);
+        return *this;
+    }
+
+    template <typename E>
+    Matrix& operator += (const MatrixExpression<T, N, E>& expr) {
+        const E& e = expr.get();
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] += e.at(i, j);
+        return *this;
+    }
+
+    template <typename E>
+    Matrix& operator -= (const MatrixExpression<T, N, E>& expr) {
+        const E& e = expr.get();
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] -= e.at(i, j);
+        return *this;
+    }
+
+    Matrix& operator *= (const Matrix& other);
+
+    const T& at(size_t i, size_t j) const {
+        return data[i][j];
+    }
+
+    T& operator() (size_t i, size_t j) {
+        return data[i][j];
+    }
+
+    const T& operator() (size_t i, size_t j) const {
+        return data[i][j];
+    }
+
+    T * operator [] (size_t i) {
+        return data[i];
+    }
+
+    const T * operator [] (size_t i) const {
+        return data[i];
+    }
+};
+
+// Сами операторы теперь только строят узлы дерева выражения
+template <typename T, int N, typename L, typename R>
+BinaryExpression<T, N, L, R, Plus> operator + (const MatrixExpression<T, N, L>& l, const MatrixExpression<T, N, R>& r) {
+    return BinaryExpression<T, N, L, R, Plus>(l.get(), r.get());
+}
+
+template <typename T, int N, typename L, typename R>
+BinaryExpression<T, N, L, R, Minus> operator - (const MatrixExpression<T, N, L>& l, const MatrixExpression<T, N, R>& r) {
+    return BinaryExpression<T, N, L, R, Minus>(l.get(), r.get());
+}
+
+template <typename T, int N, typename E>
+ScaledExpression<T, N, E> operator * (const T& lambda, const MatrixExpression<T, N, E>& e) {
+    return ScaledExpression<T, N, E>(lambda, e.get());
+}
+
+// С умножением матриц так поступать нельзя: элемент произведения зависит от целой строки и целого столбца,
+// и "ленивое" произведение внутри другого произведения пересчитывало бы одни и те же суммы по многу раз.
+// Поэтому произведение вычисляется сразу, но прямо в матрицу-результат.
+// Порядок циклов i-k-j выбран так, чтобы внутренний цикл шёл по строкам B и C подряд по памяти.
+//
+// Операнд-выражение вычисляем во временную матрицу ровно один раз, а операнд-матрицу берём по ссылке:
+// копировать её незачем, это лишние N * N присваиваний на каждое умножение.
+template <typename T, int N, typename E>
+struct EvaluatedOperand {
+    typedef const Matrix<T, N> type;
+};
+
+template <typename T, int N>
+struct EvaluatedOperand<T, N, Matrix<T, N>> {
+    typedef const Matrix<T, N>& type;
+};
+
+template <typename T, int N, typename L, typename R>
+Matrix<T, N> operator * (const MatrixExpression<T, N, L>& l, const MatrixExpression<T, N, R>& r) {
+    typename EvaluatedOperand<T, N, L>::type A(l.get());
+    typename EvaluatedOperand<T, N, R>::type B(r.get());
+    Matrix<T, N> C;
+    for (size_t i = 0; i != N; ++i)
+        for (size_t k = 0; k != N; ++k) {
+            const T a = A(i, k);
+            for (size_t j = 0; j != N; ++j)
+                C(i, j) += a * B(k, j);
+        }
+    return C;
+}
+
+// Для A *= B целая временная матрица не нужна: i-я строка произведения зависит только от i-й строки A.
+// Поэтому достаточно буфера на одну строку. Исключение - случай A *= A: тогда строки A нужны целиком до самого конца.
+template <typename T, int N>
+Matrix<T, N>& Matrix<T, N>::operator *= (const Matrix<T, N>& other) {
+    if (this == &other)
+        return *this = *this * other;
+    T row[N];
+    for (size_t i = 0; i != N; ++i) {
+        for (size_t j = 0; j != N; ++j)
+            row[j] = 0;
+        for (size_t k = 0; k != N; ++k) {
+            const T a = data[i][k];
+            for (size_t j = 0; j != N; ++j)
+                row[j] += a * other.data[k][j];
+        }
+        for (size_t j = 0; j != N; ++j)
+            data[i][j] = row[j];
+    }
+    return *this;
+}
+
+template <typename T, int N>
+std::ostream& operator << (std::ostream& out, const Matrix<T, N>& A) {
+    for (size_t i = 0; i != N; ++i) {
+        for (size_t j = 0; j != N; ++j)
+            out << A(i, j) << "\t";
+        out << "\n";
+    }
+    return out;
+}
+
+int main() {
+    Matrix<int, 3> A(1), B(2), C, D(3);
+    C(0, 1) = C(1, 2) = 5;
+
+    Matrix<int, 3> E = A + B + C * D;  // одна временная матрица (для C * D) и один проход для сложения
+    E -= 2 * (A - B);  // а здесь временных матриц нет вовсе
+    E *= C;  // буфер только на одну строку
+    std::cout << E << "\n";
+}
+
+// Именно так устроены "настоящие" библиотеки линейной алгебры (например, Eigen или Blaze).
+// Обратная сторона приёма - очень длинные имена типов в сообщениях об ошибках компиляции
+// и опасность написать auto E = A + B: в E окажется не матрица, а выражение со ссылками на A и B.
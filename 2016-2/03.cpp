@@ -260,3 +260,212 @@ void g(const int& a, const char& c) {  // Так делать не надо! Э
     // передавайте такие параметры просто по значению, как int или char
 }
 
+
+
+// ------------------
+
+// Дополнение: как быстро прочитать очень большую таблицу
+
+// Программа из начала лекции читает каждое число через std::cin >> table[i][j].
+// Для таблиц в сотни мегабайт это медленно по двум причинам:
+// 1. operator >> для каждого числа заново проверяет состояние потока и учитывает локаль (например, разделитель дробной части);
+// 2. у каждой строки vector<vector<int>> свой блок в динамической памяти, и строки разбросаны по памяти.
+// Поступим иначе:
+// 1. прочитаем весь вход одним куском в строку (fread большими порциями);
+// 2. будем хранить таблицу в одном векторе из rows * columns элементов: элемент (i, j) лежит на месте i * columns + j;
+// 3. разбирать числа будем функцией std::from_chars (C++17): она не знает про локали и ничего не выделяет;
+// 4. разрежем текст на куски по числу ядер и разберём их параллельно в нескольких потоках.
+// Всё нужное пишем прямо здесь, только стандартной библиотекой, так что программа собирается отдельно.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Ошибку во входных данных сообщаем исключением, в котором написано, что не так
+class TableFormatException {
+public:
+    std::string Reason;
+};
+
+template <typename T>  // T - int, long long, double и т. п.
+struct Table {
+    size_t rows = 0, columns = 0;
+    std::vector<T> data;  // все элементы подряд, строка за строкой
+
+    T * operator [] (size_t i) {  // table[i][j] работает как и раньше: table[i] - это указатель на начало строки
+        return data.data() + i * columns;
+    }
+
+    const T * operator [] (size_t i) const {
+        return data.data() + i * columns;
+    }
+};
+
+// Если вход - обычный файл (перенаправление ./a.out < table.txt), его размер известен заранее,
+// и строку можно выделить один раз, а не наращивать по мере чтения.
+std::string readAll(std::FILE * input) {
+    std::string text;
+    if (std::fseek(input, 0, SEEK_END) == 0) {
+        long size = std::ftell(input);
+        std::rewind(input);
+        if (size > 0)
+            text.reserve(size);
+    }
+    std::vector<char> buffer(1 << 20);
+    size_t n;
+    while ((n = std::fread(buffer.data(), 1, buffer.size(), input)) > 0)
+        text.append(buffer.data(), n);
+    return text;
+}
+
+// Разделителем считаем пробел и любой управляющий символ (табуляцию, перевод строки)
+bool isSpace(char c) {
+    return static_cast<unsigned char>(c) <= ' ';
+}
+
+// Делим текст на parts кусков примерно равной длины; границы сдвигаем вперёд до пробельного символа,
+// чтобы ни одно число не оказалось разрезанным между двумя кусками.
+std::vector<const char *> split(const char * begin, const char * end, size_t parts) {
+    std::vector<const char *> bounds(parts + 1, end);
+    bounds[0] = begin;
+    for (size_t k = 1; k < parts; ++k) {
+        const char * p = std::max(bounds[k - 1], begin + (end - begin) / parts * k);
+        while (p != end && !isSpace(*p))
+            ++p;
+        bounds[k] = p;
+    }
+    return bounds;
+}
+
+// Число начинается там, где после разделителя идёт не разделитель
+size_t countTokens(const char * begin, const char * end) {
+    size_t count = 0;
+    bool previousIsSpace = true;
+    for (const char * p = begin; p != end; ++p) {
+        const bool space = isSpace(*p);
+        count += previousIsSpace & !space;
+        previousIsSpace = space;
+    }
+    return count;
+}
+
+// Разбираем count подряд идущих чисел в out. Возвращаем указатель на место, где остановились.
+// from_chars<T> разбирает именно T: целые читаются как целые, без промежуточного double,
+// который теряет точность у чисел больше 2^53, а переполнение int честно считается ошибкой.
+template <typename T>
+const char * parseRange(const char * p, const char * end, T * out, size_t count) {
+    for (size_t k = 0; k != count; ++k) {
+        while (p != end && isSpace(*p))
+            ++p;
+        if (p != end && *p == '+')  // from_chars не принимает явный плюс
+            ++p;
+        auto [next, error] = std::from_chars(p, end, out[k]);
+        if (error != std::errc() || (next != end && !isSpace(*next)))
+            throw TableFormatException{"cannot parse number: " + std::string(p, std::find_if(p, end, isSpace))};
+        p = next;
+    }
+    return p;
+}
+
+// Сначала каждый поток считает числа в своём куске, затем по префиксным суммам
+// узнаёт, с какого места писать, и разбирает свой кусок прямо в общий буфер: ни векторов на поток, ни склейки.
+// Исключение из потока нельзя просто так выпустить наружу, поэтому сохраняем его и перебрасываем после join.
+template <typename T>
+void parse(const char * begin, const char * end, T * out, size_t count, size_t threads) {
+    const size_t MinBytesPerThread = 1 << 20;  // маленькие тексты разбираем в одном потоке: создать поток дороже
+    threads = std::max<size_t>(1, std::min<size_t>(threads, (end - begin) / MinBytesPerThread));
+    const auto bounds = split(begin, end, threads);
+
+    std::vector<size_t> offsets(threads + 1);
+    std::vector<std::exception_ptr> errors(threads);
+    auto runParallel = [&](auto job) {
+        std::vector<std::thread> workers;
+        for (size_t k = 0; k != threads; ++k)
+            workers.emplace_back([&, k] {
+                try {
+                    job(k);
+                } catch (...) {
+                    errors[k] = std::current_exception();
+                }
+            });
+        for (auto& w : workers)
+            w.join();
+        for (auto& e : errors)
+            if (e)
+                std::rethrow_exception(e);
+    };
+
+    runParallel([&](size_t k) { offsets[k + 1] = countTokens(bounds[k], bounds[k + 1]); });
+    for (size_t k = 0; k != threads; ++k)
+        offsets[k + 1] += offsets[k];
+    if (offsets[threads] != count)
+        throw TableFormatException{
+            "expected " + std::to_string(count) + " numbers, found " + std::to_string(offsets[threads])};
+
+    runParallel([&](size_t k) {
+        parseRange(bounds[k], bounds[k + 1], out + offsets[k], offsets[k + 1] - offsets[k]);
+    });
+}
+
+// Размерам из заголовка верим не сразу: в тексте длины L не бывает больше (L + 1) / 2 чисел,
+// поэтому заведомо ложный заголовок отвергаем раньше, чем выделим под него память.
+template <typename T>
+Table<T> readTable(const std::string& text, size_t threads) {
+    const char * begin = text.data();
+    const char * end = begin + text.size();
+
+    size_t sizes[2];
+    begin = parseRange(begin, end, sizes, 2);
+    const size_t count = sizes[0] * sizes[1];
+    if (sizes[1] != 0 && count / sizes[1] != sizes[0])
+        throw TableFormatException{"table size overflows"};
+    if (count > size_t(end - begin + 1) / 2)
+        throw TableFormatException{"table size " + std::to_string(sizes[0]) + " x " + std::to_string(sizes[1])
+            + " does not fit into " + std::to_string(end - begin) + " bytes"};
+
+    Table<T> table;
+    table.rows = sizes[0];
+    table.columns = sizes[1];
+    table.data.resize(count);
+    parse(begin, end, table.data.data(), count, threads);
+    return table;
+}
+
+int main() {
+    std::ios_base::sync_with_stdio(false);  // раз уж читаем через fread, отвяжем и вывод от stdio
+    const std::string text = readAll(stdin);
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Скорость разбора печатаем в cerr, чтобы она не смешивалась с самой таблицей в cout
+    Table<int> table;  // как и в начале лекции, таблица целых чисел; для дробных напишите Table<double>
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        table = readTable<int>(text, threads);
+    } catch (const TableFormatException& e) {
+        std::cerr << "bad table: " << e.Reason << "\n";
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << text.size() / 1e6 << " MB parsed in " << seconds << " s, "
+              << text.size() / 1e6 / seconds << " MB/s, " << threads << " threads\n";
+
+    for (size_t i = 0; i != table.rows; ++i) {
+        for (size_t j = 0; j != table.columns; ++j)
+            std::cout << table[i][j] << "\t";
+        std::cout << "\n";
+    }
+}
+
+// Здесь важно, что элементы таблицы лежат подряд:
+// при обходе по строкам процессор читает память последовательно, и кэш используется полностью.
+// Один поток упирается в скорость самой from_chars: таблица 2500 x 4000 целых чисел до 10^9 по модулю (104 МБ текста)
+// при сборке с -O2 разбирается на одном ядре примерно за 0,42 с, то есть около 250 МБ/с (дробные числа - медленнее).
+// Значит, гигабайт в секунду - это не меньше четырёх-пяти ядер, по которым разбор делится почти без потерь;
+// на одном ядре эта скорость недостижима, и программа честно печатает в cerr, сколько получилось.
+// Собирать программу с потоками нужно с ключом -pthread: g++ -std=c++17 -O2 -pthread table.cpp
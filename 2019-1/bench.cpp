@@ -0,0 +1,493 @@
+// Замеры производительности для Matrix<T, N>.
+// Сборка: g++ -std=c++17 -O2 -march=native -pthread bench.cpp -o bench
+// Запуск: ./bench [strassen | elementwise | transpose | power | io | variants | all]
+// Результаты печатаются построчно, поля разделены табуляцией: их удобно читать скриптом.
+
+#include "matrix.h"
+#include "matrix_io.h"
+#include "modint.h"
+#include "variants.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+template <typename Function>
+double measureSeconds(Function f, size_t repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r != repeats; ++r)
+        f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+// Не даём компилятору выбросить вычисления, результат которых никто не читает
+template <typename T>
+void keep(T * p) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(p) : "memory");
+#else
+    static T * volatile sink;
+    sink = p;
+#endif
+}
+
+// Зерно задаём явно: буферы одного размера с одинаковым зерном совпали бы,
+// и умножение считало бы A * A вместо A * B
+template <typename T>
+std::vector<T> randomBuffer(size_t size, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<T> v(size);
+    for (auto& x : v)
+        x = static_cast<T>(distribution(generator));
+    return v;
+}
+
+// Точка, в которой Штрассен обгоняет классическое умножение, зависит от процессора и типа элементов.
+// Для каждого N сравниваем классическое блочное ядро и Штрассена с разными порогами.
+// Большие матрицы не помещаются на стек, поэтому работаем с ядрами напрямую, на буферах в куче.
+template <size_t N, size_t Cutoff>
+void benchStrassenCutoff(const std::vector<double>& a, const std::vector<double>& b, std::vector<double>& c, size_t repeats) {
+    std::vector<double> scratch(N * N);
+    double seconds = measureSeconds([&] {
+        matrix_kernels::Strassen<double, N, Cutoff>::multiply(a.data(), N, b.data(), N, c.data(), N, scratch.data());
+    }, repeats);
+    std::cout << "strassen\t" << N << "\t" << Cutoff << "\t" << seconds * 1e3 << "\n";
+}
+
+template <size_t N>
+void benchStrassen() {
+    auto a = randomBuffer<double>(N * N, 1);
+    auto b = randomBuffer<double>(N * N, 2);
+    std::vector<double> c(N * N);
+    const size_t repeats = N >= 512 ? 2 : 2048 * 1024 * 8 / (N * N * N) + 1;
+
+    double seconds = measureSeconds([&] {
+        matrix_kernels::multiplyBlocked(a.data(), N, b.data(), N, c.data(), N, N);
+    }, repeats);
+    std::cout << "classic\t" << N << "\t-\t" << seconds * 1e3 << "\n";
+
+    benchStrassenCutoff<N, 32>(a, b, c, repeats);
+    benchStrassenCutoff<N, 64>(a, b, c, repeats);
+    benchStrassenCutoff<N, 128>(a, b, c, repeats);
+    benchStrassenCutoff<N, 256>(a, b, c, repeats);
+}
+
+void runStrassen() {
+    std::cout << "# kernel\tN\tcutoff\tms\n";
+    benchStrassen<64>();
+    benchStrassen<128>();
+    benchStrassen<256>();
+    benchStrassen<512>();
+    benchStrassen<1024>();
+}
+
+// Поэлементные операции: сравниваем прежний вложенный цикл по индексам m[i][j] с SIMD-ядром.
+// Печатаем пропускную способность в миллиардах элементов результата в секунду.
+template <typename T, size_t N>
+Matrix<T, N> subtractNaive(const Matrix<T, N>& m1, const Matrix<T, N>& m2) {
+    Matrix<T, N> result;
+    for (size_t i = 0; i != N; ++i)
+        for (size_t j = 0; j != N; ++j)
+            result[i][j] = m1[i][j] - m2[i][j];
+    return result;
+}
+
+template <typename T, size_t N, typename Operation>
+void benchElementwiseOperation(const char * name, Operation operation) {
+    auto a = std::make_unique<Matrix<T, N>>();
+    auto b = std::make_unique<Matrix<T, N>>();
+    auto c = std::make_unique<Matrix<T, N>>();
+    auto random = randomBuffer<T>(N * N, 1);
+    std::copy(random.begin(), random.end(), a->begin());
+    std::reverse(random.begin(), random.end());
+    std::copy(random.begin(), random.end(), b->begin());
+
+    const size_t repeats = (1 << 26) / (N * N) + 1;
+    double seconds = measureSeconds([&] {
+        operation(*a, *b, *c);
+        keep(c->data());
+    }, repeats);
+    std::cout << "elementwise\t" << name << "\t" << N << "\t" << N * N / seconds * 1e-9 << "\n";
+}
+
+template <typename T, size_t N>
+void benchElementwise() {
+    typedef Matrix<T, N> M;
+    benchElementwiseOperation<T, N>("naive_sub", [](const M& a, const M& b, M& c) { c = subtractNaive(a, b); });
+    benchElementwiseOperation<T, N>("sub", [](const M& a, const M& b, M& c) { c = a - b; });
+    benchElementwiseOperation<T, N>("add_assign", [](const M& a, const M& b, M& c) { c = a; c += b; });
+    benchElementwiseOperation<T, N>("scale", [](const M& a, const M&, M& c) { c = a * T(0.5); });
+    benchElementwiseOperation<T, N>("hadamard", [](const M& a, const M& b, M& c) { c = hadamard(a, b); });
+    benchElementwiseOperation<T, N>("fma", [](const M& a, const M& b, M& c) { c = fusedMultiplyAdd(a, b, a); });
+}
+
+void runElementwise() {
+    std::cout << "# elementwise\toperation\tN\tGelements/s\n";
+    benchElementwise<float, 3>();
+    benchElementwise<float, 4>();
+    benchElementwise<float, 16>();
+    benchElementwise<float, 64>();
+    benchElementwise<float, 256>();
+}
+
+// Транспонирование: наивное копирование против кэш-независимого transposeInto
+template <size_t N>
+void benchTranspose() {
+    auto a = randomBuffer<double>(N * N, 1);
+    std::vector<double> b(N * N);
+    MatrixView<const double> src(a.data(), N, N, N, 1);
+    MatrixView<double> dst(b.data(), N, N, N, 1);
+    const size_t repeats = (1 << 24) / (N * N) + 1;
+
+    double seconds = measureSeconds([&] {
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                dst(j, i) = src(i, j);
+        keep(b.data());
+    }, repeats);
+    std::cout << "transpose\tnaive\t" << N << "\t" << seconds * 1e9 / (N * N) << "\n";
+
+    seconds = measureSeconds([&] {
+        transposeInto<double>(src, dst);
+        keep(b.data());
+    }, repeats);
+    std::cout << "transpose\toblivious\t" << N << "\t" << seconds * 1e9 / (N * N) << "\n";
+}
+
+void runTranspose() {
+    std::cout << "# transpose\talgorithm\tN\tns/element\n";
+    benchTranspose<64>();
+    benchTranspose<512>();
+    benchTranspose<2048>();
+}
+
+// Быстрое возведение в степень: время растёт как log n, поэтому показатели вплоть до 10^18.
+// Для сравнения на небольших показателях печатаем и наивное перемножение n раз.
+template <typename T, size_t N>
+void benchPower(const char * name) {
+    auto m = std::make_unique<Matrix<T, N>>();
+    auto random = randomBuffer<double>(N * N, 1);
+    for (size_t i = 0; i != N * N; ++i)
+        m->data()[i] = T(static_cast<long long>((random[i] + 1) * 1000));
+    auto result = std::make_unique<Matrix<T, N>>();
+
+    const unsigned long long exponents[] = {10, 1000, 100000, 1000000000ULL, 1000000000000ULL, 1000000000000000000ULL};
+    for (unsigned long long n : exponents) {
+        const size_t repeats = N >= 64 ? 4 : 4096 / N + 1;
+        double seconds = measureSeconds([&] {
+            *result = power(*m, n);
+            keep(result->data());
+        }, repeats);
+        std::cout << "power\t" << name << "\t" << N << "\t" << n << "\t" << seconds * 1e6 << "\n";
+
+        if (n <= 100000 && N <= 8) {
+            seconds = measureSeconds([&] {
+                *result = identityMatrix<T, N>();
+                for (unsigned long long k = 0; k != n; ++k)
+                    *result = *result * *m;
+                keep(result->data());
+            }, 1);
+            std::cout << "naive\t" << name << "\t" << N << "\t" << n << "\t" << seconds * 1e6 << "\n";
+        }
+    }
+}
+
+void runPower() {
+    typedef ModInt<1000000007> Z;
+    std::cout << "# algorithm\ttype\tN\texponent\tus\n";
+    benchPower<Z, 2>("mod");
+    benchPower<Z, 8>("mod");
+    benchPower<Z, 64>("mod");
+    benchPower<unsigned long long, 8>("uint64");
+}
+
+// Ввод и вывод: прежние operator << и >> против to_chars/from_chars и двоичного формата с mmap.
+// Печатаем скорость в мегабайтах текста (или двоичных данных) в секунду.
+void reportIo(const char * name, size_t bytes, double seconds) {
+    std::cout << "io\t" << name << "\t" << bytes << "\t" << bytes / seconds * 1e-6 << "\n";
+}
+
+void runIo() {
+    const size_t N = 1024;
+    const std::string path = "bench_matrix.bin";
+    auto m = std::make_unique<Matrix<double, N>>();
+    auto copy = std::make_unique<Matrix<double, N>>();
+    auto random = randomBuffer<double>(N * N, 1);
+    std::copy(random.begin(), random.end(), m->begin());
+
+    std::cout << "# io\tmethod\tbytes\tMB/s\n";
+    std::string text;
+    double seconds = measureSeconds([&] {
+        std::ostringstream out;
+        out << *m;
+        text = out.str();
+    }, 1);
+    reportIo("ostream_write", text.size(), seconds);
+
+    seconds = measureSeconds([&] {
+        std::istringstream in(text);
+        for (auto& x : *copy)
+            in >> x;
+    }, 1);
+    reportIo("istream_read", text.size(), seconds);
+
+    seconds = measureSeconds([&] {
+        std::ostringstream out;
+        writeText(out, *m);
+        text = out.str();
+    }, 1);
+    reportIo("to_chars_write", text.size(), seconds);
+
+    seconds = measureSeconds([&] {
+        readText(text.data(), text.data() + text.size(), *copy);
+    }, 3);
+    reportIo("from_chars_read", text.size(), seconds);
+
+    seconds = measureSeconds([&] {
+        std::ofstream out(path, std::ios::binary);
+        writeBinary(out, *m);
+    }, 3);
+    reportIo("binary_write", N * N * sizeof(double), seconds);
+
+    double sum = 0;
+    seconds = measureSeconds([&] {
+        MappedMatrix<double> mapped(path);  // сюда входит и проверка заголовка, и обход всех страниц
+        for (size_t i = 0; i != mapped.rows(); ++i)
+            for (size_t j = 0; j != mapped.columns(); ++j)
+                sum += mapped(i, j);
+    }, 3);
+    keep(&sum);
+    reportIo("mmap_read", N * N * sizeof(double), seconds);
+    std::remove(path.c_str());
+}
+
+// Сравнение всех вариантов матрицы из лекций (см. variants.h) с Matrix<T, N> из matrix.h
+// на одних и тех же операциях. Для каждой операции печатаем время в наносекундах на элемент матрицы
+// и, если операция арифметическая, скорость в GFLOP/s (сложение - N^2 операций, умножение - 2 N^3).
+// Каждый вариант описан "адаптером" с одинаковым набором статических функций.
+template <typename T, size_t N>
+struct Fixed2019 {
+    typedef Matrix<T, N> M;
+    static constexpr const char * Name = "2019-1";
+
+    static M make() {
+        return identityMatrix<T, N>();
+    }
+
+    static T sum(const M& m) {
+        T s = 0;
+        for (const T& x : m)
+            s += x;
+        return s;
+    }
+
+    static M add(const M& a, const M& b) {
+        return a + b;
+    }
+
+    static M multiply(const M& a, const M& b) {
+        return a * b;
+    }
+};
+
+template <typename T, size_t N>
+struct Fixed20 {
+    typedef lecture20::Matrix<T, N> M;
+    static constexpr const char * Name = "20";
+
+    static M make() {
+        return M(1);
+    }
+
+    static T sum(const M& m) {
+        T s = 0;
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                s += m(i, j);
+        return s;
+    }
+
+    static M add(const M& a, const M& b) {
+        return a + b;
+    }
+
+    static M multiply(const M& a, const M& b) {
+        return a * b;
+    }
+};
+
+template <typename T, size_t N>
+struct RowIterator08 {
+    typedef lecture08::Matrix<T, N> M;
+    static constexpr const char * Name = "2016-1/08";
+
+    static M make() {
+        return M(1);
+    }
+
+    static T sum(const M& m) {
+        T s = 0;
+        for (const T& x : m)
+            s += x;
+        return s;
+    }
+
+    static M add(const M& a, const M& b) {
+        return a + b;
+    }
+
+    static M multiply(const M& a, const M& b) {
+        return a * b;
+    }
+};
+
+template <typename T, size_t N>
+struct Rows21 {
+    typedef lecture21::RowsMatrix<T> M;
+    static constexpr const char * Name = "21_rows";
+
+    static M make() {
+        return M(N, 1);
+    }
+
+    static T sum(const M& m) {
+        T s = 0;
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                s += m[i][j];
+        return s;
+    }
+
+    static M add(const M& a, const M& b) {
+        return a + b;
+    }
+
+    static M multiply(const M& a, const M& b) {
+        return a * b;
+    }
+};
+
+template <typename T, size_t N>
+struct Flat21 {
+    typedef lecture21::FlatMatrix<T> M;
+    static constexpr const char * Name = "21_flat";
+
+    static M make() {
+        return M(N, 1);
+    }
+
+    static T sum(const M& m) {
+        T s = 0;
+        for (size_t k = 0; k != N * N; ++k)
+            s += m.data()[k];
+        return s;
+    }
+
+    static M add(const M& a, const M& b) {
+        return a + b;
+    }
+
+    static M multiply(const M& a, const M& b) {
+        return a * b;
+    }
+};
+
+void reportVariant(const char * name, const char * operation, const char * type, size_t n, double seconds, double flops) {
+    std::cout << "variants\t" << name << "\t" << operation << "\t" << type << "\t" << n
+        << "\t" << seconds * 1e9 / (n * n) << "\t";
+    if (flops > 0)
+        std::cout << flops / seconds * 1e-9;
+    else
+        std::cout << "-";
+    std::cout << "\n";
+}
+
+template <template <typename, size_t> class Variant, typename T, size_t N>
+void benchVariant(const char * type) {
+    typedef Variant<T, N> V;
+    typedef typename V::M M;
+    auto a = std::make_unique<M>(V::make());
+    auto b = std::make_unique<M>(V::make());
+    auto c = std::make_unique<M>(V::make());
+    const size_t repeats = (1 << 22) / (N * N) + 1;
+    const size_t multiplyRepeats = (1 << 24) / (N * N * N) + 1;
+
+    double seconds = measureSeconds([&] {
+        *c = V::make();
+        keep(c.get());
+    }, repeats);
+    reportVariant(V::Name, "construct", type, N, seconds, 0);
+
+    seconds = measureSeconds([&] {
+        *c = *a;
+        keep(c.get());
+    }, repeats);
+    reportVariant(V::Name, "copy", type, N, seconds, 0);
+
+    T sum = 0;
+    seconds = measureSeconds([&] {
+        sum += V::sum(*a);
+        keep(&sum);
+    }, repeats);
+    reportVariant(V::Name, "iterate", type, N, seconds, double(N) * N);
+
+    seconds = measureSeconds([&] {
+        *c = V::add(*a, *b);
+        keep(c.get());
+    }, repeats);
+    reportVariant(V::Name, "add", type, N, seconds, double(N) * N);
+
+    seconds = measureSeconds([&] {
+        *c = V::multiply(*a, *b);
+        keep(c.get());
+    }, multiplyRepeats);
+    reportVariant(V::Name, "multiply", type, N, seconds, 2.0 * N * N * N);
+}
+
+template <typename T, size_t N>
+void benchVariantsOfSize(const char * type) {
+    benchVariant<Fixed2019, T, N>(type);
+    benchVariant<Fixed20, T, N>(type);
+    benchVariant<RowIterator08, T, N>(type);
+    benchVariant<Rows21, T, N>(type);
+    benchVariant<Flat21, T, N>(type);
+}
+
+template <typename T>
+void benchVariantsOfType(const char * type) {
+    benchVariantsOfSize<T, 4>(type);
+    benchVariantsOfSize<T, 16>(type);
+    benchVariantsOfSize<T, 64>(type);
+    benchVariantsOfSize<T, 256>(type);
+}
+
+void runVariants() {
+    std::cout << "# variants\timplementation\toperation\ttype\tN\tns/element\tGFLOP/s\n";
+    benchVariantsOfType<int>("int");
+    benchVariantsOfType<float>("float");
+    benchVariantsOfType<double>("double");
+}
+
+int main(int argc, char ** argv) {
+    std::string mode = argc > 1 ? argv[1] : "all";
+    if (mode == "strassen" || mode == "all")
+        runStrassen();
+    if (mode == "elementwise" || mode == "all")
+        runElementwise();
+    if (mode == "transpose" || mode == "all")
+        runTranspose();
+    if (mode == "power" || mode == "all")
+        runPower();
+    if (mode == "io" || mode == "all")
+        runIo();
+    if (mode == "variants" || mode == "all")
+        runVariants();
+}
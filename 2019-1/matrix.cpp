@@ -1,122 +1,10 @@
-#include <array>
+#include "matrix.h"
+#include "modint.h"
+
 #include <iostream>
 
 using namespace std;
 
-template <typename T, size_t N>
-class Matrix;
-
-template <typename T, size_t N>
-class MatrixIterator {
-private:
-    Matrix<T, N>& matrix;
-    size_t row, column;
-
-public:
-    MatrixIterator(
-        Matrix<T, N>& m,
-        size_t i,
-        size_t j
-    ) : matrix(m), row(i), column(j)
-    {
-    }
-
-    bool operator == (MatrixIterator other) const {
-        return row == other.row
-                && column == other.column;
-    }
-
-    bool operator != (MatrixIterator other) const {
-        return !(*this == other);
-    }
-
-    T& operator * () {
-        return matrix[row][column];
-    }
-
-    MatrixIterator& operator ++ () {
-        ++column;
-        if (column == N) {
-            ++row;
-            column = 0;
-        }
-        return *this;
-    }
-
-    MatrixIterator operator ++ (int) {
-        auto tmp = *this;
-        ++*this;
-        return tmp;
-    }
-};
-
-template <typename T, size_t N>
-class Matrix {
-private:
-    array<array<T, N>, N> data;
-
-public:
-    MatrixIterator<T, N> begin() {
-        return {*this, 0, 0};
-    }
-
-    MatrixIterator<T, N> end() {
-        return {*this, N, 0};
-    }
-    const array<T, N>&
-    operator [] (size_t row) const {
-        return data[row];
-    }
-
-    array<T, N>&
-    operator [] (size_t row) {
-        return data[row];
-    }
-};
-
-template <typename T, size_t N>
-ostream& operator << (
-    ostream& out,
-    const Matrix<T, N>& m
-) {
-    for (size_t i = 0; i != N; ++i) {
-        for (size_t j = 0; j != N; ++j) {
-            if (j > 0)
-                out << '\t';
-            out << m[i][j];
-        }
-        out << '\n';
-    }
-    return out;
-}
-
-template <typename T, size_t N>
-Matrix<T, N> operator - (
-    const Matrix<T, N>& m1,
-    const Matrix<T, N>& m2
-) {
-    Matrix<T, N> result;
-    for (size_t i = 0; i != N; ++i) {
-        for (size_t j = 0; j != N; ++j)
-            result[i][j] = m1[i][j] - m2[i][j];
-    }
-    return result;
-}
-
-template <typename T, size_t N>
-Matrix<T, N>& operator -= (
-    Matrix<T, N>& m1,
-    const Matrix<T, N>& m2
-) {
-    for (size_t i = 0; i != N; ++i) {
-        for (size_t j = 0; j != N; ++j)
-            m1[i][j] -= m2[i][j];
-    }
-    return m1;
-}
-
-
-
 int main() {
     Matrix<int, 2> A;
     A[0][0] = 1;
@@ -137,4 +25,24 @@ int main() {
         ++elem;
 
     std::cout << A << "\n";
+
+    std::cout << A * B << "\n";
+
+    for (auto it = A.indexed().begin(); it != A.indexed().end(); ++it)
+        if (it.row() == it.column())
+            *it = 0;
+
+    std::cout << A << "\n";
+
+    constexpr Matrix<double, 2> R({0, -1, 1, 0});  // поворот на 90 градусов
+    static_assert(determinant(R) == 1, "rotation must preserve area");
+    std::cout << inverse(R) << "\n";
+
+    A.row(0) += A.column(1).transposed();  // строки, столбцы и транспонирование - без копирования
+    std::cout << A + B.transposed() << "\n";
+
+    // Число Фибоначчи с номером 10^18 по модулю 10^9 + 7: около 120 умножений матриц 2 x 2
+    typedef ModInt<1000000007> Z;
+    std::cout << linearRecurrence<Z, 2>({1, 1}, {0, 1}, 1000000000000000000ULL) << "\n";
+    std::cout << power(A, 3) << "\n";
 }
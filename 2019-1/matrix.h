@@ -0,0 +1,1126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T, size_t N>
+class Matrix;
+
+// Элементы матрицы хранятся построчно в одном непрерывном массиве из N * N элементов.
+// Поэтому перебирать их можно обычным указателем: это итератор произвольного доступа,
+// и циклы вида for (auto& elem : A), а также std::fill, std::transform и т. п. компилятор векторизует.
+//
+// Если при переборе нужны ещё и индексы элемента, есть MatrixIterator (см. Matrix::indexed()).
+// Он тоже хранит только указатель, а строку и столбец вычисляет по запросу,
+// так что и у него operator ++ не содержит ветвлений.
+template <typename T, size_t N>
+class MatrixIterator {
+private:
+    T * base;  // начало матрицы
+    T * current;
+
+public:
+    MatrixIterator(T * b, T * c): base(b), current(c) {
+    }
+
+    bool operator == (MatrixIterator other) const {
+        return current == other.current;
+    }
+
+    bool operator != (MatrixIterator other) const {
+        return !(*this == other);
+    }
+
+    T& operator * () const {
+        return *current;
+    }
+
+    size_t row() const {
+        return (current - base) / N;
+    }
+
+    size_t column() const {
+        return (current - base) % N;
+    }
+
+    MatrixIterator& operator ++ () {
+        ++current;
+        return *this;
+    }
+
+    MatrixIterator operator ++ (int) {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+};
+
+// Диапазон, который возвращает Matrix::indexed(): for (auto it = r.begin(); it != r.end(); ++it) ... it.row() ...
+template <typename T, size_t N>
+class IndexedRange {
+private:
+    T * first;
+
+public:
+    explicit IndexedRange(T * f): first(f) {
+    }
+
+    MatrixIterator<T, N> begin() const {
+        return {first, first};
+    }
+
+    MatrixIterator<T, N> end() const {
+        return {first, first + N * N};
+    }
+};
+
+// Представление (view) - лёгкий объект, который ничем не владеет, а лишь описывает,
+// где в памяти лежат элементы некоторой прямоугольной матрицы: указатель на элемент (0, 0),
+// размеры и два шага - на сколько элементов сдвигаться при переходе к следующей строке и к следующему столбцу.
+// Элемент (i, j) лежит по адресу origin + i * rowStride + j * columnStride.
+// Такого описания хватает, чтобы без копирования получить транспонированную матрицу (шаги меняются местами),
+// подматрицу (сдвигаем origin и уменьшаем размеры), строку и столбец.
+// MatrixView<T> позволяет изменять элементы, MatrixView<const T> - только читать.
+
+class DifferentSizeException {  // размеры операндов не совпали
+public:
+    size_t Rows1, Columns1, Rows2, Columns2;
+};
+
+template <typename T>
+class MatrixView {
+private:
+    T * origin;
+    size_t Rows, Columns;
+    std::ptrdiff_t RowStride, ColumnStride;
+
+    template <typename>
+    friend class MatrixView;
+
+public:
+    typedef typename std::remove_const<T>::type value_type;
+
+    MatrixView(T * o, size_t rows, size_t columns, std::ptrdiff_t rowStride, std::ptrdiff_t columnStride)
+        : origin(o), Rows(rows), Columns(columns), RowStride(rowStride), ColumnStride(columnStride)
+    {
+    }
+
+    template <size_t N>
+    MatrixView(Matrix<value_type, N>& m): MatrixView(m.data(), N, N, N, 1) {
+    }
+
+    template <size_t N>
+    MatrixView(const Matrix<value_type, N>& m): MatrixView(m.data(), N, N, N, 1) {
+    }
+
+    // Из изменяемого представления всегда можно получить константное
+    operator MatrixView<const value_type> () const {
+        return MatrixView<const value_type>(origin, Rows, Columns, RowStride, ColumnStride);
+    }
+
+    size_t rows() const {
+        return Rows;
+    }
+
+    size_t columns() const {
+        return Columns;
+    }
+
+    std::ptrdiff_t rowStride() const {
+        return RowStride;
+    }
+
+    std::ptrdiff_t columnStride() const {
+        return ColumnStride;
+    }
+
+    bool empty() const {
+        return Rows == 0 || Columns == 0;
+    }
+
+    // Элементы каждой строки лежат в памяти подряд: по ним можно идти обычным указателем
+    bool hasContiguousRows() const {
+        return ColumnStride == 1;
+    }
+
+    T& operator () (size_t i, size_t j) const {
+        return origin[i * RowStride + j * ColumnStride];
+    }
+
+    // Первый и последний адрес, которых касается непустое представление
+    std::pair<const value_type *, const value_type *> extent() const {
+        std::ptrdiff_t low = 0, high = 0;
+        for (std::ptrdiff_t step : {RowStride * std::ptrdiff_t(Rows - 1), ColumnStride * std::ptrdiff_t(Columns - 1)})
+            (step < 0 ? low : high) += step;
+        return {origin + low, origin + high};
+    }
+
+    MatrixView transposed() const {
+        return MatrixView(origin, Columns, Rows, ColumnStride, RowStride);
+    }
+
+    // Подматрица rows x columns с левым верхним углом в (i, j)
+    MatrixView block(size_t i, size_t j, size_t rows, size_t columns) const {
+        return MatrixView(&(*this)(i, j), rows, columns, RowStride, ColumnStride);
+    }
+
+    MatrixView row(size_t i) const {
+        return block(i, 0, 1, Columns);
+    }
+
+    MatrixView column(size_t j) const {
+        return block(0, j, Rows, 1);
+    }
+
+    // Задевают ли два представления общую память. Сравниваем диапазоны адресов [наименьший, наибольший]:
+    // шаги могут быть отрицательными, а указатели на разные массивы упорядочивает только std::less.
+    bool overlaps(MatrixView<const value_type> other) const {
+        if (empty() || other.empty())
+            return false;
+        const auto a = extent(), b = other.extent();
+        std::less<const void *> less;
+        return !(less(a.second, b.first) || less(b.second, a.first));
+    }
+
+    // Те же элементы в том же порядке: поэлементная операция тогда читает каждый элемент до того, как пишет в него
+    bool sameElements(MatrixView<const value_type> other) const {
+        return origin == other.origin && Rows == other.Rows && Columns == other.Columns
+            && RowStride == other.RowStride && ColumnStride == other.ColumnStride;
+    }
+
+    // Поэлементные операции над тем, на что смотрит представление.
+    // Оператор = не перегружаем: было бы непонятно, копирует он элементы или "перевешивает" представление.
+    // Если other перекрывается с приёмником иначе, чем поэлемент (A += A.transposed()), цикл прочитал бы
+    // уже перезаписанные элементы - поэтому такой источник сначала копируется.
+    template <typename Op>
+    void update(MatrixView<const value_type> other, Op op) const {
+        if (Rows != other.rows() || Columns != other.columns())
+            throw DifferentSizeException{Rows, Columns, other.rows(), other.columns()};
+        if (overlaps(other) && !sameElements(other)) {
+            std::vector<value_type> copy(Rows * Columns);
+            for (size_t i = 0; i != Rows; ++i)
+                for (size_t j = 0; j != Columns; ++j)
+                    copy[i * Columns + j] = other(i, j);
+            update(MatrixView<const value_type>(copy.data(), Rows, Columns, Columns, 1), op);
+            return;
+        }
+        for (size_t i = 0; i != Rows; ++i) {
+            if (hasContiguousRows() && other.hasContiguousRows()) {  // быстрый путь: векторизуемый цикл по указателям
+                T * dst = &(*this)(i, 0);
+                const value_type * src = &other(i, 0);
+                for (size_t j = 0; j != Columns; ++j)
+                    op(dst[j], src[j]);
+            } else {
+                for (size_t j = 0; j != Columns; ++j)
+                    op((*this)(i, j), other(i, j));
+            }
+        }
+    }
+
+    const MatrixView& assign(MatrixView<const value_type> other) const {
+        update(other, [](T& x, const value_type& y) { x = y; });
+        return *this;
+    }
+
+    const MatrixView& operator += (MatrixView<const value_type> other) const {
+        update(other, [](T& x, const value_type& y) { x += y; });
+        return *this;
+    }
+
+    const MatrixView& operator -= (MatrixView<const value_type> other) const {
+        update(other, [](T& x, const value_type& y) { x -= y; });
+        return *this;
+    }
+
+    const MatrixView& operator *= (const value_type& lambda) const {
+        for (size_t i = 0; i != Rows; ++i)
+            for (size_t j = 0; j != Columns; ++j)
+                (*this)(i, j) *= lambda;
+        return *this;
+    }
+};
+
+template <typename T, size_t N>
+class Matrix {
+private:
+    std::array<T, N * N> elements;
+
+public:
+    typedef T * iterator;
+    typedef const T * const_iterator;
+
+    Matrix() = default;  // элементы, как и раньше, не инициализируются
+
+    // Матрица из элементов, перечисленных построчно. Конструктор constexpr:
+    // constexpr Matrix<int, 2> A({1, 2, 3, 4});
+    constexpr explicit Matrix(const std::array<T, N * N>& e): elements(e) {
+    }
+
+    // Материализация представления размера N x N (например, транспонированной матрицы или блока)
+    explicit Matrix(MatrixView<const T> v) {
+        view().assign(v);
+    }
+
+    constexpr T * data() {
+        return elements.data();
+    }
+
+    constexpr const T * data() const {
+        return elements.data();
+    }
+
+    constexpr iterator begin() {
+        return elements.data();
+    }
+
+    constexpr iterator end() {
+        return elements.data() + N * N;
+    }
+
+    constexpr const_iterator begin() const {
+        return elements.data();
+    }
+
+    constexpr const_iterator end() const {
+        return elements.data() + N * N;
+    }
+
+    IndexedRange<T, N> indexed() {
+        return IndexedRange<T, N>(elements.data());
+    }
+
+    IndexedRange<const T, N> indexed() const {
+        return IndexedRange<const T, N>(elements.data());
+    }
+
+    // Представления без копирования данных
+    MatrixView<T> view() {
+        return MatrixView<T>(*this);
+    }
+
+    MatrixView<const T> view() const {
+        return MatrixView<const T>(*this);
+    }
+
+    MatrixView<T> transposed() {
+        return view().transposed();
+    }
+
+    MatrixView<const T> transposed() const {
+        return view().transposed();
+    }
+
+    MatrixView<T> block(size_t i, size_t j, size_t rows, size_t columns) {
+        return view().block(i, j, rows, columns);
+    }
+
+    MatrixView<const T> block(size_t i, size_t j, size_t rows, size_t columns) const {
+        return view().block(i, j, rows, columns);
+    }
+
+    MatrixView<T> row(size_t i) {
+        return view().row(i);
+    }
+
+    MatrixView<const T> row(size_t i) const {
+        return view().row(i);
+    }
+
+    MatrixView<T> column(size_t j) {
+        return view().column(j);
+    }
+
+    MatrixView<const T> column(size_t j) const {
+        return view().column(j);
+    }
+
+    // Строка матрицы - указатель на её первый элемент, так что по-прежнему можно писать m[i][j]
+    constexpr const T * operator [] (size_t row) const {
+        return elements.data() + row * N;
+    }
+
+    constexpr T * operator [] (size_t row) {
+        return elements.data() + row * N;
+    }
+};
+
+template <typename T, size_t N>
+std::ostream& operator << (
+    std::ostream& out,
+    const Matrix<T, N>& m
+) {
+    for (size_t i = 0; i != N; ++i) {
+        for (size_t j = 0; j != N; ++j) {
+            if (j > 0)
+                out << '\t';
+            out << m[i][j];
+        }
+        out << '\n';
+    }
+    return out;
+}
+
+// Поэлементные операции.
+// Все они сводятся к одному ядру matrix_simd::map, которое проходит по плоскому массиву элементов.
+// Для встроенных числовых типов ядро явно работает с SIMD-векторами по 16 или 32 байта
+// (векторные расширения GCC и Clang: компилятор сам выберет SSE, AVX или NEON),
+// а оставшиеся в конце элементы (scalar tail) досчитывает по одному.
+// Для маленьких матриц (до 16 элементов) цикла нет вовсе: он разворачивается при компиляции.
+
+namespace matrix_simd {
+
+// Векторизуем только целые типы, float и double; для остальных (bool, long double, классы) lanes == 1
+template <typename T>
+struct IsVectorizable {
+    static constexpr bool value = (std::is_integral<T>::value && !std::is_same<T, bool>::value)
+        || std::is_same<T, float>::value || std::is_same<T, double>::value;
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#ifdef __AVX__
+const size_t VectorBytes = 32;
+#else
+const size_t VectorBytes = 16;  // без AVX 32-байтные векторы эмулируются парами 16-байтных и меняют ABI вызовов
+#endif
+
+template <typename T>
+struct Vector {
+    typedef typename std::conditional<IsVectorizable<T>::value, T, int>::type Element;
+    typedef Element type __attribute__((vector_size(VectorBytes)));
+    static constexpr size_t lanes = IsVectorizable<T>::value ? VectorBytes / sizeof(T) : 1;
+};
+#else
+template <typename T>
+struct Vector {
+    typedef T type;
+    static constexpr size_t lanes = 1;
+};
+#endif
+
+const size_t UnrollLimit = 16;
+
+template <typename V, typename T>
+V load(const T * p) {
+    V v;
+    std::memcpy(&v, p, sizeof(V));  // невыровненная загрузка; компилятор превратит её в одну инструкцию
+    return v;
+}
+
+template <typename T, typename V>
+void store(T * p, const V& v) {
+    std::memcpy(p, &v, sizeof(V));
+}
+
+template <size_t I, typename T, typename Op, typename... In>
+void mapOne(T * out, Op op, const In *... in) {
+    out[I] = op(in[I]...);
+}
+
+template <typename T, typename Op, typename... In, size_t... I>
+void mapUnrolled(T * out, Op op, std::index_sequence<I...>, const In *... in) {
+    (mapOne<I>(out, op, in...), ...);
+}
+
+// out[i] = op(in1[i], in2[i], ...) для i от 0 до Size - 1.
+// Функтор op должен уметь работать и с отдельными элементами, и с векторами (обычно это generic-лямбда).
+template <size_t Size, typename T, typename Op, typename... In>
+void map(T * out, Op op, const In *... in) {
+    if constexpr (Size <= UnrollLimit || Vector<T>::lanes == 1) {
+        if constexpr (Size <= UnrollLimit) {
+            mapUnrolled(out, op, std::make_index_sequence<Size>(), in...);
+        } else {
+            for (size_t i = 0; i != Size; ++i)
+                out[i] = op(in[i]...);
+        }
+    } else {
+        typedef typename Vector<T>::type V;
+        constexpr size_t L = Vector<T>::lanes;
+        constexpr size_t VectorEnd = Size - Size % L;
+        for (size_t i = 0; i != VectorEnd; i += L)
+            store(out + i, op(load<V>(in + i)...));
+        for (size_t i = VectorEnd; i != Size; ++i)
+            out[i] = op(in[i]...);
+    }
+}
+
+}  // namespace matrix_simd
+
+template <typename T, size_t N>
+Matrix<T, N>& operator += (
+    Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    matrix_simd::map<N * N>(m1.data(), [](auto x, auto y) { return x + y; }, m1.data(), m2.data());
+    return m1;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator + (
+    const Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    Matrix<T, N> result;
+    matrix_simd::map<N * N>(result.data(), [](auto x, auto y) { return x + y; }, m1.data(), m2.data());
+    return result;
+}
+
+template <typename T, size_t N>
+Matrix<T, N>& operator -= (
+    Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    matrix_simd::map<N * N>(m1.data(), [](auto x, auto y) { return x - y; }, m1.data(), m2.data());
+    return m1;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator - (
+    const Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    Matrix<T, N> result;
+    matrix_simd::map<N * N>(result.data(), [](auto x, auto y) { return x - y; }, m1.data(), m2.data());
+    return result;
+}
+
+template <typename T, size_t N>
+Matrix<T, N>& operator *= (
+    Matrix<T, N>& m,
+    const T& lambda
+) {
+    matrix_simd::map<N * N>(m.data(), [lambda](auto x) { return x * lambda; }, m.data());
+    return m;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator * (
+    const Matrix<T, N>& m,
+    const T& lambda
+) {
+    Matrix<T, N> result;
+    matrix_simd::map<N * N>(result.data(), [lambda](auto x) { return x * lambda; }, m.data());
+    return result;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator * (
+    const T& lambda,
+    const Matrix<T, N>& m
+) {
+    return m * lambda;
+}
+
+// Произведение Адамара: поэлементное произведение матриц (не путать с обычным умножением матриц!)
+template <typename T, size_t N>
+Matrix<T, N> hadamard(
+    const Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    Matrix<T, N> result;
+    matrix_simd::map<N * N>(result.data(), [](auto x, auto y) { return x * y; }, m1.data(), m2.data());
+    return result;
+}
+
+// Поэлементно a * b + c за один проход. С -mfma (или -march=native) компилятор использует инструкции FMA.
+template <typename T, size_t N>
+Matrix<T, N> fusedMultiplyAdd(
+    const Matrix<T, N>& a,
+    const Matrix<T, N>& b,
+    const Matrix<T, N>& c
+) {
+    Matrix<T, N> result;
+    matrix_simd::map<N * N>(result.data(), [](auto x, auto y, auto z) { return x * y + z; }, a.data(), b.data(), c.data());
+    return result;
+}
+
+// m += lambda * other без временной матрицы
+template <typename T, size_t N>
+Matrix<T, N>& addScaled(
+    Matrix<T, N>& m,
+    const T& lambda,
+    const Matrix<T, N>& other
+) {
+    matrix_simd::map<N * N>(m.data(), [lambda](auto x, auto y) { return x + lambda * y; }, m.data(), other.data());
+    return m;
+}
+
+// Умножение матриц.
+// Все ядра ниже работают с "кусками" матриц, заданными указателем на левый верхний элемент
+// и шагом (stride) - расстоянием в памяти между соседними строками.
+// Тогда четверть матрицы - это тот же указатель со смещением и тот же шаг, без всякого копирования.
+
+namespace matrix_kernels {
+
+// Строка C += a * строка B.
+// При -O2 GCC векторизует только циклы с известным числом итераций и без проверок на перекрытие массивов,
+// поэтому идём порциями по Lanes элементов, а массивы помечаем как __restrict (они не пересекаются).
+template <typename T>
+inline void addScaledRow(T * __restrict c, const T * __restrict b, T a, size_t n) {
+    const size_t Lanes = 16;
+    size_t j = 0;
+    for (; j + Lanes <= n; j += Lanes)
+        for (size_t t = 0; t != Lanes; ++t)
+            c[j + t] += a * b[j + t];
+    for (; j != n; ++j)
+        c[j] += a * b[j];
+}
+
+// Классическое умножение C = A * B для квадратных кусков размера n x n.
+// Порядок циклов i-k-j: внутренний цикл идёт подряд по строкам B и C и хорошо векторизуется.
+// Дополнительно режем k и j на блоки, чтобы используемый кусок B помещался в кэш.
+// Куски не должны перекрываться: C обнуляется раньше, чем прочитаны A и B (multiply ниже это проверяет сам).
+template <typename T>
+void multiplyBlocked(
+    const T * a, size_t lda,
+    const T * b, size_t ldb,
+    T * c, size_t ldc,
+    size_t n
+) {
+    const size_t block = 64;
+    for (size_t i = 0; i != n; ++i)
+        std::fill(c + i * ldc, c + i * ldc + n, T(0));
+    for (size_t k0 = 0; k0 < n; k0 += block) {
+        const size_t k1 = std::min(k0 + block, n);
+        for (size_t j0 = 0; j0 < n; j0 += 4 * block) {
+            const size_t j1 = std::min(j0 + 4 * block, n);
+            for (size_t i = 0; i != n; ++i)
+                for (size_t k = k0; k != k1; ++k)
+                    addScaledRow(c + i * ldc + j0, b + k * ldb + j0, a[i * lda + k], j1 - j0);
+        }
+    }
+}
+
+template <typename T>
+void add(const T * a, size_t lda, const T * b, size_t ldb, T * c, size_t ldc, size_t n) {
+    for (size_t i = 0; i != n; ++i)
+        for (size_t j = 0; j != n; ++j)
+            c[i * ldc + j] = a[i * lda + j] + b[i * ldb + j];
+}
+
+template <typename T>
+void subtract(const T * a, size_t lda, const T * b, size_t ldb, T * c, size_t ldc, size_t n) {
+    for (size_t i = 0; i != n; ++i)
+        for (size_t j = 0; j != n; ++j)
+            c[i * ldc + j] = a[i * lda + j] - b[i * ldb + j];
+}
+
+// c = sign * m  или  c += sign * m, в зависимости от accumulate
+template <typename T>
+void update(T * c, size_t ldc, const T * m, size_t n, int sign, bool accumulate) {
+    for (size_t i = 0; i != n; ++i) {
+        T * crow = c + i * ldc;
+        const T * mrow = m + i * n;
+        if (!accumulate) {
+            for (size_t j = 0; j != n; ++j)
+                crow[j] = sign > 0 ? mrow[j] : -mrow[j];
+        } else if (sign > 0) {
+            for (size_t j = 0; j != n; ++j)
+                crow[j] += mrow[j];
+        } else {
+            for (size_t j = 0; j != n; ++j)
+                crow[j] -= mrow[j];
+        }
+    }
+}
+
+// Алгоритм Штрассена: вместо 8 умножений половинок делаем 7, ценой 18 сложений.
+// Размер N - шаблонный параметр, поэтому глубина рекурсии известна при компиляции:
+// if constexpr выбирает между рекурсией и базовым ядром, и лишние ветки даже не компилируются.
+// Рекурсия продолжается, пока размер чётный и больше Cutoff.
+//
+// Вместо семи временных матриц M1, ..., M7 используем одну: каждое Mi сразу разносится по четвертям C:
+//     C11 = M1 + M4 - M5 + M7,  C12 = M3 + M5,  C21 = M2 + M4,  C22 = M1 - M2 + M3 + M6.
+// На каждом уровне нужно 3 * (N/2)^2 элементов рабочей памяти (две суммы-операнда и Mi),
+// а на всех уровнях вместе - меньше N^2. Этот буфер выделяется один раз снаружи.
+template <typename T, size_t N, size_t Cutoff>
+struct Strassen {
+    static void multiply(
+        const T * a, size_t lda,
+        const T * b, size_t ldb,
+        T * c, size_t ldc,
+        T * scratch
+    ) {
+        if constexpr (N % 2 != 0 || N <= Cutoff) {
+            multiplyBlocked(a, lda, b, ldb, c, ldc, N);
+        } else {
+            constexpr size_t H = N / 2;
+            const T * a11 = a;
+            const T * a12 = a + H;
+            const T * a21 = a + H * lda;
+            const T * a22 = a + H * lda + H;
+            const T * b11 = b;
+            const T * b12 = b + H;
+            const T * b21 = b + H * ldb;
+            const T * b22 = b + H * ldb + H;
+            T * c11 = c;
+            T * c12 = c + H;
+            T * c21 = c + H * ldc;
+            T * c22 = c + H * ldc + H;
+
+            T * ta = scratch;
+            T * tb = ta + H * H;
+            T * m = tb + H * H;
+            T * next = m + H * H;
+            typedef Strassen<T, H, Cutoff> Half;
+
+            // M1 = (A11 + A22)(B11 + B22)
+            add(a11, lda, a22, lda, ta, H, H);
+            add(b11, ldb, b22, ldb, tb, H, H);
+            Half::multiply(ta, H, tb, H, m, H, next);
+            update(c11, ldc, m, H, +1, false);
+            update(c22, ldc, m, H, +1, false);
+
+            // M2 = (A21 + A22) B11
+            add(a21, lda, a22, lda, ta, H, H);
+            Half::multiply(ta, H, b11, ldb, m, H, next);
+            update(c21, ldc, m, H, +1, false);
+            update(c22, ldc, m, H, -1, true);
+
+            // M3 = A11 (B12 - B22)
+            subtract(b12, ldb, b22, ldb, tb, H, H);
+            Half::multiply(a11, lda, tb, H, m, H, next);
+            update(c12, ldc, m, H, +1, false);
+            update(c22, ldc, m, H, +1, true);
+
+            // M4 = A22 (B21 - B11)
+            subtract(b21, ldb, b11, ldb, tb, H, H);
+            Half::multiply(a22, lda, tb, H, m, H, next);
+            update(c11, ldc, m, H, +1, true);
+            update(c21, ldc, m, H, +1, true);
+
+            // M5 = (A11 + A12) B22
+            add(a11, lda, a12, lda, ta, H, H);
+            Half::multiply(ta, H, b22, ldb, m, H, next);
+            update(c11, ldc, m, H, -1, true);
+            update(c12, ldc, m, H, +1, true);
+
+            // M6 = (A21 - A11)(B11 + B12)
+            subtract(a21, lda, a11, lda, ta, H, H);
+            add(b11, ldb, b12, ldb, tb, H, H);
+            Half::multiply(ta, H, tb, H, m, H, next);
+            update(c22, ldc, m, H, +1, true);
+
+            // M7 = (A12 - A22)(B21 + B22)
+            subtract(a12, lda, a22, lda, ta, H, H);
+            add(b21, ldb, b22, ldb, tb, H, H);
+            Half::multiply(ta, H, tb, H, m, H, next);
+            update(c11, ldc, m, H, +1, true);
+        }
+    }
+};
+
+}  // namespace matrix_kernels
+
+// Порог, ниже которого Штрассен невыгоден: лишние сложения и обращения к памяти перевешивают
+// сэкономленное умножение. Значение подобрано по замерам (см. bench.cpp, режим strassen).
+const size_t StrassenCutoff = 64;
+
+template <typename T, size_t N>
+Matrix<T, N> multiplyClassic(
+    const Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    Matrix<T, N> result;
+    matrix_kernels::multiplyBlocked(m1.data(), N, m2.data(), N, result.data(), N, N);
+    return result;
+}
+
+template <typename T, size_t N, size_t Cutoff = StrassenCutoff>
+Matrix<T, N> multiplyStrassen(
+    const Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    Matrix<T, N> result;
+    std::vector<T> scratch(N * N);
+    matrix_kernels::Strassen<T, N, Cutoff>::multiply(
+        m1.data(), N, m2.data(), N, result.data(), N, scratch.data());
+    return result;
+}
+
+// Маленькие матрицы (2x2, 3x3, 4x4).
+// Для них циклы и проверки в общих алгоритмах стоят дороже самой арифметики,
+// поэтому умножение, определитель и обратная матрица выписаны явно, без единого цикла.
+// Все эти функции constexpr: их можно вычислять и во время компиляции,
+// а в обычном коде получается линейная последовательность независимых умножений и сложений,
+// которую компилятор хорошо раскладывает по SSE/AVX-регистрам.
+
+class ZeroDeterminantException {
+};
+
+namespace small_matrix {
+
+template <typename T, size_t N, size_t I, size_t... K>
+constexpr T dot(const Matrix<T, N>& a, const Matrix<T, N>& b, std::index_sequence<K...>) {
+    return ((a[I / N][K] * b[K][I % N]) + ...);
+}
+
+template <typename T, size_t N, size_t... I>
+constexpr Matrix<T, N> multiply(const Matrix<T, N>& a, const Matrix<T, N>& b, std::index_sequence<I...>) {
+    return Matrix<T, N>({dot<T, N, I>(a, b, std::make_index_sequence<N>())...});
+}
+
+}  // namespace small_matrix
+
+template <typename T, size_t N>
+constexpr Matrix<T, N> multiplySmall(
+    const Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    return small_matrix::multiply(m1, m2, std::make_index_sequence<N * N>());
+}
+
+template <typename T, size_t N>
+constexpr T determinant(const Matrix<T, N>& m) {
+    static_assert(N >= 1 && N <= 4, "determinant() is implemented only for matrices up to 4x4");
+    if constexpr (N == 1) {
+        return m[0][0];
+    } else if constexpr (N == 2) {
+        return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+    } else if constexpr (N == 3) {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+             - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+             + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    } else {
+        // Разложение Лапласа по первым двум строкам: 2x2-миноры верхних строк на дополнительные миноры нижних
+        const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+        const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+        const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+}
+
+// Обратная матрица через присоединённую: A^{-1} = adj(A) / det(A).
+// Для целых T деление будет целочисленным, так что имеет смысл вызывать её для float, double и т. п.
+template <typename T, size_t N>
+constexpr Matrix<T, N> inverse(const Matrix<T, N>& m) {
+    static_assert(N >= 1 && N <= 4, "inverse() is implemented only for matrices up to 4x4");
+    if constexpr (N == 1) {
+        if (m[0][0] == T(0))
+            throw ZeroDeterminantException();
+        return Matrix<T, N>({T(1) / m[0][0]});
+    } else if constexpr (N == 2) {
+        const T det = determinant(m);
+        if (det == T(0))
+            throw ZeroDeterminantException();
+        return Matrix<T, N>({
+            m[1][1] / det, -m[0][1] / det,
+            -m[1][0] / det, m[0][0] / det
+        });
+    } else if constexpr (N == 3) {
+        const T b00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+        const T b10 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+        const T b20 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+        const T det = m[0][0] * b00 + m[0][1] * b10 + m[0][2] * b20;
+        if (det == T(0))
+            throw ZeroDeterminantException();
+        return Matrix<T, N>({
+            b00 / det,
+            (m[0][2] * m[2][1] - m[0][1] * m[2][2]) / det,
+            (m[0][1] * m[1][2] - m[0][2] * m[1][1]) / det,
+            b10 / det,
+            (m[0][0] * m[2][2] - m[0][2] * m[2][0]) / det,
+            (m[0][2] * m[1][0] - m[0][0] * m[1][2]) / det,
+            b20 / det,
+            (m[0][1] * m[2][0] - m[0][0] * m[2][1]) / det,
+            (m[0][0] * m[1][1] - m[0][1] * m[1][0]) / det
+        });
+    } else {
+        // Те же 2x2-миноры, что и в determinant(): каждый из них входит сразу в несколько элементов ответа
+        const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+        const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+        const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (det == T(0))
+            throw ZeroDeterminantException();
+        return Matrix<T, N>({
+            (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) / det,
+            (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) / det,
+            (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) / det,
+            (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) / det,
+
+            (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) / det,
+            (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) / det,
+            (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) / det,
+            (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) / det,
+
+            (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) / det,
+            (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) / det,
+            (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) / det,
+            (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) / det,
+
+            (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) / det,
+            (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) / det,
+            (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) / det,
+            (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) / det
+        });
+    }
+}
+
+template <typename T, size_t N>
+constexpr Matrix<T, N> operator * (
+    const Matrix<T, N>& m1,
+    const Matrix<T, N>& m2
+) {
+    if constexpr (N <= 4)
+        return multiplySmall(m1, m2);
+    else if constexpr (N > StrassenCutoff && N % 2 == 0)
+        return multiplyStrassen(m1, m2);
+    else
+        return multiplyClassic(m1, m2);
+}
+
+// Представления в арифметике.
+// Identity нужен, чтобы параметр-представление не участвовал в выводе шаблонных аргументов:
+// T и N выводятся из матрицы, а MatrixView<T> или сама матрица неявно приводятся к MatrixView<const T>.
+template <typename T>
+struct Identity {
+    typedef T type;
+};
+
+template <typename T, size_t N>
+Matrix<T, N>& operator += (
+    Matrix<T, N>& m,
+    typename Identity<MatrixView<const T>>::type v
+) {
+    m.view() += v;
+    return m;
+}
+
+template <typename T, size_t N>
+Matrix<T, N>& operator -= (
+    Matrix<T, N>& m,
+    typename Identity<MatrixView<const T>>::type v
+) {
+    m.view() -= v;
+    return m;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator + (
+    const Matrix<T, N>& m,
+    typename Identity<MatrixView<const T>>::type v
+) {
+    Matrix<T, N> result(m);
+    return result += v;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator + (
+    typename Identity<MatrixView<const T>>::type v,
+    const Matrix<T, N>& m
+) {
+    return m + v;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator - (
+    const Matrix<T, N>& m,
+    typename Identity<MatrixView<const T>>::type v
+) {
+    Matrix<T, N> result(m);
+    return result -= v;
+}
+
+template <typename T, size_t N>
+Matrix<T, N> operator - (
+    typename Identity<MatrixView<const T>>::type v,
+    const Matrix<T, N>& m
+) {
+    Matrix<T, N> result(v);
+    return result -= m;
+}
+
+// C = A * B для представлений произвольных согласованных размеров.
+// Если строки B и C лежат подряд, внутренний цикл i-k-j идёт по ним указателями.
+// C обнуляется до чтения A и B, поэтому если C перекрывается с ними (multiply(a, b, a)),
+// произведение считается во временный буфер и только потом копируется в C.
+template <typename T>
+void multiply(
+    typename Identity<MatrixView<const T>>::type a,
+    typename Identity<MatrixView<const T>>::type b,
+    MatrixView<T> c
+) {
+    if (a.columns() != b.rows())
+        throw DifferentSizeException{a.rows(), a.columns(), b.rows(), b.columns()};
+    if (c.rows() != a.rows() || c.columns() != b.columns())
+        throw DifferentSizeException{c.rows(), c.columns(), a.rows(), b.columns()};
+    if (c.overlaps(a) || c.overlaps(b)) {
+        std::vector<T> buffer(c.rows() * c.columns());
+        const MatrixView<T> temporary(buffer.data(), c.rows(), c.columns(), c.columns(), 1);
+        multiply<T>(a, b, temporary);
+        c.assign(temporary);
+        return;
+    }
+    const size_t n = c.columns();
+    for (size_t i = 0; i != c.rows(); ++i) {
+        for (size_t j = 0; j != n; ++j)
+            c(i, j) = T(0);
+        for (size_t k = 0; k != a.columns(); ++k) {
+            const T aik = a(i, k);
+            if (b.hasContiguousRows() && c.hasContiguousRows()) {
+                T * crow = &c(i, 0);
+                const T * brow = &b(k, 0);
+                for (size_t j = 0; j != n; ++j)
+                    crow[j] += aik * brow[j];
+            } else {
+                for (size_t j = 0; j != n; ++j)
+                    c(i, j) += aik * b(k, j);
+            }
+        }
+    }
+}
+
+// Если транспонированную матрицу нужно получить "по-настоящему", наивное копирование
+// dst(j, i) = src(i, j) плохо работает с кэшем: либо чтение, либо запись идёт с большим шагом,
+// и каждое обращение затрагивает новую кэш-линию.
+// Кэш-независимый (cache-oblivious) алгоритм делит большую сторону пополам, пока куски не станут маленькими.
+// На каком-то уровне рекурсии куски обязательно поместятся в кэш любого размера - поэтому размер кэша знать не нужно.
+// Как и в multiply, приёмник может перекрываться с источником (transposeInto(m, m.view()) для квадратной m):
+// тогда транспонируем во временный буфер, иначе запись затёрла бы ещё не прочитанные элементы.
+template <typename T>
+void transposeInto(
+    typename Identity<MatrixView<const T>>::type src,
+    MatrixView<T> dst
+) {
+    if (src.rows() != dst.columns() || src.columns() != dst.rows())
+        throw DifferentSizeException{src.columns(), src.rows(), dst.rows(), dst.columns()};
+    if (dst.overlaps(src)) {
+        std::vector<T> buffer(dst.rows() * dst.columns());
+        const MatrixView<T> temporary(buffer.data(), dst.rows(), dst.columns(), dst.columns(), 1);
+        transposeInto<T>(src, temporary);
+        dst.assign(temporary);
+        return;
+    }
+    const size_t leaf = 16;
+    if (src.rows() <= leaf && src.columns() <= leaf) {
+        for (size_t i = 0; i != src.rows(); ++i)
+            for (size_t j = 0; j != src.columns(); ++j)
+                dst(j, i) = src(i, j);
+    } else if (src.rows() >= src.columns()) {
+        const size_t half = src.rows() / 2;
+        transposeInto<T>(src.block(0, 0, half, src.columns()), dst.block(0, 0, dst.rows(), half));
+        transposeInto<T>(src.block(half, 0, src.rows() - half, src.columns()), dst.block(0, half, dst.rows(), dst.columns() - half));
+    } else {
+        const size_t half = src.columns() / 2;
+        transposeInto<T>(src.block(0, 0, src.rows(), half), dst.block(0, 0, half, dst.columns()));
+        transposeInto<T>(src.block(0, half, src.rows(), src.columns() - half), dst.block(half, 0, dst.rows() - half, dst.columns()));
+    }
+}
+
+template <typename T, size_t N>
+Matrix<T, N> transpose(const Matrix<T, N>& m) {
+    Matrix<T, N> result;
+    transposeInto<T>(m, result.view());
+    return result;
+}
+
+// Возведение в степень.
+// Единичная матрица нужна как "нулевая степень"
+template <typename T, size_t N>
+constexpr Matrix<T, N> identityMatrix() {
+    Matrix<T, N> result(std::array<T, N * N>{});
+    for (size_t i = 0; i != N; ++i)
+        result[i][i] = T(1);
+    return result;
+}
+
+namespace matrix_kernels {
+
+// c = a * b для N x N, без выделения памяти: для больших N Штрассену нужен внешний scratch размера N * N
+template <typename T, size_t N>
+void multiplyInto(const T * a, const T * b, T * c, T * scratch) {
+    if constexpr (N > StrassenCutoff && N % 2 == 0)
+        Strassen<T, N, StrassenCutoff>::multiply(a, N, b, N, c, N, scratch);
+    else
+        multiplyBlocked(a, N, b, N, c, N, N);
+}
+
+}  // namespace matrix_kernels
+
+// Быстрое возведение в степень (как power2 для чисел): O(N^3 log n) вместо O(N^3 n).
+// Инвариант: result * base^n == const.
+// Результат произведения нельзя писать в один из его операндов, поэтому держим три буфера
+// и после каждого умножения просто меняем местами указатели ("пинг-понг"), ничего не копируя.
+// Все буферы выделяются один раз в начале, так что даже n = 10^18 (около 120 умножений) не требует новых выделений.
+template <typename T, size_t N>
+Matrix<T, N> power(const Matrix<T, N>& m, unsigned long long n) {
+    std::vector<T> buffers(3 * N * N + (N > StrassenCutoff ? N * N : 0));
+    T * result = buffers.data();
+    T * base = result + N * N;
+    T * spare = base + N * N;
+    T * scratch = spare + N * N;
+
+    for (size_t i = 0; i != N; ++i)
+        for (size_t j = 0; j != N; ++j)
+            result[i * N + j] = (i == j) ? T(1) : T(0);
+    std::copy(m.begin(), m.end(), base);
+
+    while (n != 0) {
+        if (n % 2 != 0) {
+            matrix_kernels::multiplyInto<T, N>(result, base, spare, scratch);
+            std::swap(result, spare);
+        }
+        n /= 2;
+        if (n != 0) {
+            matrix_kernels::multiplyInto<T, N>(base, base, spare, scratch);
+            std::swap(base, spare);
+        }
+    }
+
+    Matrix<T, N> answer;
+    std::copy(result, result + N * N, answer.begin());
+    return answer;
+}
+
+// n-й член линейной рекуррентной последовательности
+//     a[k] = c[0] * a[k - 1] + c[1] * a[k - 2] + ... + c[N - 1] * a[k - N]
+// по начальным значениям a[0], ..., a[N - 1].
+// Вектор (a[k + N - 1], ..., a[k]) получается из (a[N - 1], ..., a[0]) умножением на k-ю степень
+// сопровождающей матрицы (в первой строке коэффициенты c, ниже - единицы под диагональю).
+// Например, числа Фибоначчи: linearRecurrence<T, 2>({1, 1}, {0, 1}, n).
+template <typename T, size_t N>
+T linearRecurrence(
+    const std::array<T, N>& c,
+    const std::array<T, N>& initial,
+    unsigned long long n
+) {
+    if (n < N)
+        return initial[n];
+    Matrix<T, N> companion(std::array<T, N * N>{});
+    for (size_t j = 0; j != N; ++j)
+        companion[0][j] = c[j];
+    for (size_t i = 1; i != N; ++i)
+        companion[i][i - 1] = T(1);
+
+    // Нужно a[n] = первая компонента companion^(n - N + 1) * (a[N - 1], ..., a[0])
+    const Matrix<T, N> p = power(companion, n - N + 1);
+    T answer = T(0);
+    for (size_t j = 0; j != N; ++j)
+        answer += p[0][j] * initial[N - 1 - j];
+    return answer;
+}
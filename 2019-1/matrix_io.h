@@ -0,0 +1,397 @@
+#pragma once
+
+// Ввод и вывод матриц большого размера.
+//
+// operator << печатает элементы по одному через ostream, а чтение через cin >> разбирает каждое число
+// с учётом локали. Для матриц в сотни мегабайт и больше это слишком медленно, поэтому здесь есть:
+//   * двоичный формат: заголовок из 64 байт и затем элементы построчно, как они лежат в памяти;
+//   * MappedMatrix - отображение такого файла в память (mmap): данные не копируются,
+//     а страницы подгружаются операционной системой по мере обращения к представлению;
+//   * разбор текста через std::from_chars, параллельно в нескольких потоках.
+// Отображение файлов в память здесь сделано через POSIX (Linux, macOS).
+
+#include "matrix.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MatrixFormatException {  // файл повреждён, не того формата или не с тем типом элементов
+public:
+    std::string Reason;
+};
+
+// Заголовок двоичного файла.
+// Данные начинаются с DataOffset, кратного 64: так отображённые в память элементы выровнены под любые SIMD-загрузки.
+struct MatrixFileHeader {
+    char Magic[8];
+    uint32_t ByteOrder;    // записываем 0x01020304 в порядке байтов машины, которая сохраняла файл
+    uint32_t ElementKind;  // 'i' - знаковое целое, 'u' - беззнаковое, 'f' - с плавающей точкой
+    uint32_t ElementSize;
+    uint32_t Reserved;
+    uint64_t Rows, Columns;
+    uint64_t DataOffset;
+    char Padding[16];
+};
+
+static_assert(sizeof(MatrixFileHeader) == 64, "header must stay 64 bytes");
+
+namespace matrix_io {
+
+const char Magic[8] = {'M', 'A', 'T', 'R', 'I', 'X', '\0', '\1'};
+const uint32_t ByteOrder = 0x01020304;
+
+template <typename T>
+constexpr uint32_t elementKind() {
+    static_assert(std::is_arithmetic<T>::value, "binary format stores only arithmetic types");
+    return std::is_floating_point<T>::value ? 'f' : std::is_signed<T>::value ? 'i' : 'u';
+}
+
+template <typename T>
+MatrixFileHeader makeHeader(size_t rows, size_t columns) {
+    MatrixFileHeader header = {};
+    std::copy(Magic, Magic + sizeof(Magic), header.Magic);
+    header.ByteOrder = ByteOrder;
+    header.ElementKind = elementKind<T>();
+    header.ElementSize = sizeof(T);
+    header.Rows = rows;
+    header.Columns = columns;
+    header.DataOffset = sizeof(MatrixFileHeader);
+    return header;
+}
+
+// Проверяем заголовок и возвращаем смещение данных. fileSize нужен, чтобы не выйти за конец отображения.
+template <typename T>
+uint64_t checkHeader(const MatrixFileHeader& header, uint64_t fileSize) {
+    if (!std::equal(Magic, Magic + sizeof(Magic), header.Magic))
+        throw MatrixFormatException{"not a binary matrix file"};
+    if (header.ByteOrder != ByteOrder)
+        throw MatrixFormatException{"file was written with a different byte order"};
+    if (header.ElementKind != elementKind<T>() || header.ElementSize != sizeof(T))
+        throw MatrixFormatException{"element type does not match"};
+    if (header.DataOffset < sizeof(MatrixFileHeader) || header.DataOffset > fileSize || header.DataOffset % alignof(T) != 0)
+        throw MatrixFormatException{"bad data offset"};
+    if (header.Columns != 0 && header.Rows > (fileSize - header.DataOffset) / sizeof(T) / header.Columns)
+        throw MatrixFormatException{"file is truncated"};
+    return header.DataOffset;
+}
+
+}  // namespace matrix_io
+
+// Двоичная запись. Строки с непрерывными элементами пишутся одним вызовом write,
+// остальные (например, у транспонированного представления) сначала собираются в буфер.
+template <typename T>
+void writeBinary(std::ostream& out, MatrixView<T> m) {
+    typedef typename MatrixView<T>::value_type Element;
+    const MatrixFileHeader header = matrix_io::makeHeader<Element>(m.rows(), m.columns());
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<Element> row;
+    for (size_t i = 0; i != m.rows(); ++i) {
+        const Element * begin = &m(i, 0);
+        if (!m.hasContiguousRows()) {
+            row.resize(m.columns());
+            for (size_t j = 0; j != m.columns(); ++j)
+                row[j] = m(i, j);
+            begin = row.data();
+        }
+        out.write(reinterpret_cast<const char *>(begin), m.columns() * sizeof(Element));
+    }
+}
+
+template <typename T, size_t N>
+void writeBinary(std::ostream& out, const Matrix<T, N>& m) {
+    writeBinary(out, m.view());
+}
+
+template <typename T, size_t N>
+void readBinary(std::istream& in, Matrix<T, N>& m) {
+    MatrixFileHeader header;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        throw MatrixFormatException{"file is truncated"};
+    const uint64_t offset = matrix_io::checkHeader<T>(header, UINT64_MAX);
+    if (header.Rows != N || header.Columns != N)
+        throw DifferentSizeException{N, N, header.Rows, header.Columns};
+    in.ignore(offset - sizeof(header));
+    if (!in.read(reinterpret_cast<char *>(m.data()), N * N * sizeof(T)))
+        throw MatrixFormatException{"file is truncated"};
+}
+
+// Файл, целиком отображённый в память только для чтения.
+// Владеет отображением, поэтому копировать его нельзя, а перемещать можно.
+class MappedFile {
+private:
+    const char * Data = nullptr;
+    size_t Size = 0;
+
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), path);
+        }
+        Size = info.st_size;
+        if (Size != 0) {
+            void * p = ::mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), path);
+            }
+            ::madvise(p, Size, MADV_SEQUENTIAL);  // подсказка ядру: читать с упреждением
+            Data = static_cast<const char *>(p);
+        }
+        ::close(fd);  // отображение остаётся действительным и после закрытия дескриптора
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept: Data(other.Data), Size(other.Size) {
+        other.Data = nullptr;
+        other.Size = 0;
+    }
+
+    MappedFile& operator = (MappedFile&& other) noexcept {
+        std::swap(Data, other.Data);
+        std::swap(Size, other.Size);
+        return *this;
+    }
+
+    ~MappedFile() {
+        if (Data)
+            ::munmap(const_cast<char *>(Data), Size);
+    }
+
+    const char * data() const {
+        return Data;
+    }
+
+    size_t size() const {
+        return Size;
+    }
+};
+
+// Двоичный файл матрицы, отображённый в память: view() смотрит прямо на страницы файла.
+// Размер не обязан быть известен при компиляции, так что годится и для матриц в несколько гигабайт.
+template <typename T>
+class MappedMatrix {
+private:
+    MappedFile File;
+    MatrixView<const T> View;
+
+    static MatrixView<const T> makeView(const MappedFile& file) {
+        if (file.size() < sizeof(MatrixFileHeader))
+            throw MatrixFormatException{"file is truncated"};
+        MatrixFileHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        const uint64_t offset = matrix_io::checkHeader<T>(header, file.size());
+        const T * origin = reinterpret_cast<const T *>(file.data() + offset);
+        return MatrixView<const T>(origin, header.Rows, header.Columns, header.Columns, 1);
+    }
+
+public:
+    explicit MappedMatrix(const std::string& path)
+        : File(path)
+        , View(makeView(File))
+    {
+    }
+
+    MatrixView<const T> view() const {
+        return View;
+    }
+
+    size_t rows() const {
+        return View.rows();
+    }
+
+    size_t columns() const {
+        return View.columns();
+    }
+
+    const T& operator () (size_t i, size_t j) const {
+        return View(i, j);
+    }
+};
+
+namespace text_parsing {
+
+// Разделителем считаем любой управляющий символ или пробел: одно сравнение вместо четырёх,
+// а в числовых выгрузках других символов с кодом меньше пробела не бывает.
+inline bool isSpace(char c) {
+    return static_cast<unsigned char>(c) <= ' ';
+}
+
+// Делим текст на parts кусков примерно равной длины; границы сдвигаем вперёд до пробельного символа,
+// чтобы ни одно число не оказалось разрезанным между двумя кусками.
+inline std::vector<const char *> split(const char * begin, const char * end, size_t parts) {
+    std::vector<const char *> bounds(parts + 1, end);
+    bounds[0] = begin;
+    for (size_t k = 1; k < parts; ++k) {
+        const char * p = std::max(bounds[k - 1], begin + (end - begin) / parts * k);
+        while (p != end && !isSpace(*p))
+            ++p;
+        bounds[k] = p;
+    }
+    return bounds;
+}
+
+// Число начинается там, где после разделителя идёт не разделитель.
+// Проверяем по 16 байт сразу (векторы GCC, как в matrix_simd): сравнение векторов даёт -1 или 0 в каждом байте,
+// и такие маски копим в байтовых счётчиках, сбрасывая их в общий итог раньше, чем они переполнятся.
+inline size_t countTokens(const char * begin, const char * end) {
+    typedef unsigned char Bytes __attribute__((vector_size(16)));
+    const size_t size = end - begin;
+    if (size == 0)
+        return 0;
+    size_t count = !isSpace(begin[0]);
+    size_t i = 1;
+    while (i + sizeof(Bytes) <= size) {
+        Bytes starts = {};
+        for (size_t step = 0; step != 255 && i + sizeof(Bytes) <= size; ++step, i += sizeof(Bytes)) {
+            Bytes previous, current;
+            std::memcpy(&previous, begin + i - 1, sizeof(Bytes));
+            std::memcpy(&current, begin + i, sizeof(Bytes));
+            starts -= reinterpret_cast<Bytes>((previous <= ' ') & (current > ' '));
+        }
+        for (size_t k = 0; k != sizeof(Bytes); ++k)
+            count += starts[k];
+    }
+    for (; i < size; ++i)
+        count += isSpace(begin[i - 1]) & !isSpace(begin[i]);
+    return count;
+}
+
+// Разбираем подряд идущие числа в out. Возвращаем указатель на место, где остановились.
+template <typename T>
+const char * parseRange(const char * p, const char * end, T * out, size_t count) {
+    for (size_t k = 0; k != count; ++k) {
+        while (p != end && isSpace(*p))
+            ++p;
+        if (p != end && *p == '+')  // from_chars не принимает явный плюс, а в выгрузках он встречается
+            ++p;
+        auto [next, error] = std::from_chars(p, end, out[k]);
+        if (error != std::errc() || (next != end && !isSpace(*next)))
+            throw MatrixFormatException{"cannot parse number: " + std::string(p, std::find_if(p, end, isSpace))};
+        p = next;
+    }
+    return p;
+}
+
+// Сначала каждый поток считает числа в своём куске, затем по префиксным суммам
+// узнаёт, с какого места писать, и разбирает свой кусок прямо в общий непрерывный буфер.
+// Маленькие тексты разбираем в одном потоке: создание потоков дороже самого разбора.
+template <typename T>
+void parse(const char * begin, const char * end, T * out, size_t count, size_t threads) {
+    const size_t MinBytesPerThread = 1 << 20;
+    threads = std::max<size_t>(1, std::min<size_t>(threads, (end - begin) / MinBytesPerThread));
+    const auto bounds = split(begin, end, threads);
+
+    std::vector<size_t> offsets(threads + 1);
+    std::vector<std::exception_ptr> errors(threads);
+    auto runParallel = [&](auto job) {
+        std::vector<std::thread> workers;
+        for (size_t k = 1; k < threads; ++k)
+            workers.emplace_back([&, k] {
+                try {
+                    job(k);
+                } catch (...) {
+                    errors[k] = std::current_exception();
+                }
+            });
+        try {
+            job(0);
+        } catch (...) {
+            errors[0] = std::current_exception();
+        }
+        for (auto& w : workers)
+            w.join();
+        for (auto& e : errors)
+            if (e)
+                std::rethrow_exception(e);
+    };
+
+    runParallel([&](size_t k) { offsets[k + 1] = countTokens(bounds[k], bounds[k + 1]); });
+    for (size_t k = 0; k != threads; ++k)
+        offsets[k + 1] += offsets[k];
+    if (offsets[threads] != count)
+        throw MatrixFormatException{
+            "expected " + std::to_string(count) + " numbers, found " + std::to_string(offsets[threads])};
+
+    runParallel([&](size_t k) {
+        parseRange(bounds[k], bounds[k + 1], out + offsets[k], offsets[k + 1] - offsets[k]);
+    });
+}
+
+}  // namespace text_parsing
+
+// Чтение текста в формате operator << (числа через пробелы или табуляции, строки через перевод строки)
+inline size_t defaultThreads() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+template <typename T, size_t N>
+void readText(const char * begin, const char * end, Matrix<T, N>& m, size_t threads = defaultThreads()) {
+    text_parsing::parse(begin, end, m.data(), N * N, threads);
+}
+
+template <typename T, size_t N>
+void readText(std::istream& in, Matrix<T, N>& m, size_t threads = defaultThreads()) {
+    const std::string text(std::istreambuf_iterator<char>(in), {});  // читаем поток целиком одним куском
+    readText(text.data(), text.data() + text.size(), m, threads);
+}
+
+template <typename T, size_t N>
+void readTextFile(const std::string& path, Matrix<T, N>& m, size_t threads = defaultThreads()) {
+    MappedFile file(path);
+    readText(file.data(), file.data() + file.size(), m, threads);
+}
+
+// Текстовая запись с теми же разделителями, что и у operator <<, но через std::to_chars в общий буфер:
+// без локали и без вызова виртуальных функций потока на каждое число.
+// Числа с плавающей точкой печатаются кратчайшей записью, которая читается обратно без потери точности
+// (operator << по умолчанию оставляет только 6 значащих цифр).
+template <typename T>
+void writeText(std::ostream& out, MatrixView<T> m) {
+    const size_t FlushBytes = 1 << 16;
+    const size_t MaxNumberLength = 32;
+    std::string buffer(FlushBytes + 2 * MaxNumberLength, '\0');
+    size_t used = 0;
+    for (size_t i = 0; i != m.rows(); ++i) {
+        for (size_t j = 0; j != m.columns(); ++j) {
+            if (j > 0)
+                buffer[used++] = '\t';
+            used = std::to_chars(&buffer[used], &buffer[used] + MaxNumberLength, m(i, j)).ptr - buffer.data();
+            if (used >= FlushBytes) {
+                out.write(buffer.data(), used);
+                used = 0;
+            }
+        }
+        buffer[used++] = '\n';
+    }
+    out.write(buffer.data(), used);
+}
+
+template <typename T, size_t N>
+void writeText(std::ostream& out, const Matrix<T, N>& m) {
+    writeText(out, m.view());
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+// Вычет по модулю Mod: все операции выполняются по модулю, переполнения не бывает.
+// Годится как тип элементов T в Matrix<T, N>, Polynomial<T> и Complex<T> из 20.cpp:
+// нужны только конструктор от целого (в том числе от нуля) и арифметические операторы.
+//
+// Внутри число a хранится в форме Монтгомери: a * R mod Mod, где R = 2^32.
+// Тогда произведение (aR) * (bR) = abR^2 переводится обратно в abR делением на R "по модулю",
+// а такое деление делается одним умножением и сдвигом вместо деления 64-битного числа на Mod.
+// Сложение и вычитание от формы не зависят. Поэтому модуль должен быть нечётным (чтобы R было обратимо)
+// и меньше 2^31 (чтобы промежуточная сумма в reduce не переполнила 64 бита).
+//
+// Объект - это ровно одно число uint32_t без виртуальных функций,
+// так что std::vector<ModInt> лежит в памяти как обычный массив uint32_t,
+// и циклы по таким векторам компилятор может векторизовать: в reduce нет ни деления, ни ветвлений с переходом.
+template <uint32_t Mod>
+class ModInt {
+    static_assert(Mod % 2 == 1 && Mod < (1u << 31), "ModInt: модуль должен быть нечётным и меньше 2^31");
+
+private:
+    uint32_t value;  // форма Монтгомери, всегда в диапазоне [0, Mod)
+
+    // Mod^(-1) по модулю 2^32. Метод Ньютона: каждая итерация x = x * (2 - Mod * x) удваивает число верных битов,
+    // а x = Mod верен уже в трёх младших битах (Mod * Mod = 1 mod 8 для нечётного Mod).
+    static constexpr uint32_t modulusInverse() {
+        uint32_t x = Mod;
+        for (int i = 0; i != 4; ++i)
+            x *= 2 - Mod * x;
+        return x;
+    }
+
+    static constexpr uint32_t Inv = modulusInverse();
+    static constexpr uint32_t R2 = static_cast<uint32_t>(((uint64_t(1) << 32) % Mod) * ((uint64_t(1) << 32) % Mod) % Mod);
+
+    // t * R^(-1) mod Mod для t < Mod * 2^32. Число m * Mod совпадает с t в младших 32 битах,
+    // поэтому t - m * Mod делится на 2^32 нацело, и достаточно вычесть старшие половины.
+    static constexpr uint32_t reduce(uint64_t t) {
+        const uint32_t m = static_cast<uint32_t>(t) * Inv;
+        const uint32_t high = static_cast<uint32_t>(t >> 32);
+        const uint32_t correction = static_cast<uint32_t>((static_cast<uint64_t>(m) * Mod) >> 32);
+        return high >= correction ? high - correction : high - correction + Mod;
+    }
+
+public:
+    static constexpr uint32_t Modulus = Mod;
+
+    constexpr ModInt(long long x = 0)
+        : value(reduce(static_cast<uint64_t>(x % static_cast<long long>(Mod) < 0
+            ? x % static_cast<long long>(Mod) + Mod
+            : x % static_cast<long long>(Mod)) * R2))
+    {
+    }
+
+    // Обычное значение в диапазоне [0, Mod), а не форма Монтгомери
+    constexpr uint32_t get() const {
+        return reduce(value);
+    }
+
+    constexpr ModInt& operator += (ModInt other) {
+        value += other.value;
+        if (value >= Mod)
+            value -= Mod;
+        return *this;
+    }
+
+    constexpr ModInt& operator -= (ModInt other) {
+        value = value >= other.value ? value - other.value : value + Mod - other.value;
+        return *this;
+    }
+
+    constexpr ModInt& operator *= (ModInt other) {
+        value = reduce(static_cast<uint64_t>(value) * other.value);
+        return *this;
+    }
+
+    // Обратный элемент по малой теореме Ферма: a^(Mod - 2). Модуль должен быть простым.
+    constexpr ModInt inverse() const {
+        ModInt result = 1, base = *this;
+        for (uint32_t n = Mod - 2; n != 0; n /= 2) {
+            if (n % 2 != 0)
+                result *= base;
+            base *= base;
+        }
+        return result;
+    }
+
+    constexpr ModInt& operator /= (ModInt other) {
+        return *this *= other.inverse();
+    }
+
+    constexpr ModInt operator - () const {
+        return ModInt() - *this;
+    }
+
+    friend constexpr ModInt operator + (ModInt a, ModInt b) {
+        return a += b;
+    }
+
+    friend constexpr ModInt operator - (ModInt a, ModInt b) {
+        return a -= b;
+    }
+
+    friend constexpr ModInt operator * (ModInt a, ModInt b) {
+        return a *= b;
+    }
+
+    friend constexpr ModInt operator / (ModInt a, ModInt b) {
+        return a /= b;
+    }
+
+    // Форма Монтгомери взаимно однозначна, поэтому сравнивать можно её, не переводя обратно
+    friend constexpr bool operator == (ModInt a, ModInt b) {
+        return a.value == b.value;
+    }
+
+    friend constexpr bool operator != (ModInt a, ModInt b) {
+        return a.value != b.value;
+    }
+
+    friend std::ostream& operator << (std::ostream& out, ModInt a) {
+        return out << a.get();
+    }
+};
+
+// Вычисления во время компиляции: форма Монтгомери не видна снаружи
+static_assert(ModInt<1000000007>(-1).get() == 1000000006, "ModInt: неверное приведение отрицательных чисел");
+static_assert((ModInt<998244353>(3) / ModInt<998244353>(3)).get() == 1, "ModInt: неверный обратный элемент");
+static_assert(sizeof(ModInt<998244353>) == sizeof(uint32_t) && std::is_trivially_copyable<ModInt<998244353>>::value,
+    "ModInt: вектор вычетов должен лежать в памяти как массив uint32_t");
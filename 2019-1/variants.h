@@ -0,0 +1,292 @@
+#pragma once
+
+// Варианты класса "Матрица" из лекций, собранные так, чтобы их можно было сравнить с Matrix<T, N> из matrix.h.
+// В самих лекциях код разбит на фрагменты с несколькими main и специально оставленными ошибками,
+// поэтому подключить их напрямую нельзя. Здесь каждый вариант сохраняет своё устройство хранения и свои циклы,
+// а недостающие части (копирование, сложение) дописаны в том же стиле.
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// 20.cpp: статический двумерный массив T data[N][N], доступ через operator (), умножение в порядке i-j-k
+namespace lecture20 {
+
+template <typename T, size_t N>
+class Matrix {
+private:
+    T data[N][N];
+
+public:
+    Matrix(const T& lambda = 0) {
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] = (i == j) ? lambda : 0;
+    }
+
+    T& operator() (size_t i, size_t j) {
+        return data[i][j];
+    }
+
+    const T& operator() (size_t i, size_t j) const {
+        return data[i][j];
+    }
+
+    Matrix& operator += (const Matrix& other) {
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] += other.data[i][j];
+        return *this;
+    }
+
+    Matrix operator + (const Matrix& other) const {
+        Matrix C(*this);
+        C += other;
+        return C;
+    }
+};
+
+template <typename T, size_t N>
+Matrix<T, N> operator * (const Matrix<T, N>& A, const Matrix<T, N>& B) {
+    Matrix<T, N> C;
+    for (size_t i = 0; i != N; ++i)
+        for (size_t j = 0; j != N; ++j)
+            for (size_t k = 0; k != N; ++k)
+                C(i, j) += A(i, k) * B(k, j);
+    return C;
+}
+
+}  // namespace lecture20
+
+// 2016-1/08.cpp: та же матрица, но элементы перебираются итератором RowIterator,
+// который хранит указатель на матрицу и пару индексов (строка, столбец)
+namespace lecture08 {
+
+template <typename T, size_t N>
+class Matrix;
+
+template <typename T, size_t N>
+class RowIterator {
+private:
+    const Matrix<T, N> * matrix;
+    size_t row, column;
+
+public:
+    RowIterator(const Matrix<T, N> * _matrix, size_t _row = N, size_t _column = 0)
+        : matrix(_matrix)
+        , row(_row)
+        , column(_column)
+    {
+    }
+
+    const T& operator * () const {
+        return (*matrix)(row, column);
+    }
+
+    RowIterator& operator++() {
+        ++column;
+        if (column == N) {
+            column = 0;
+            ++row;
+        }
+        return *this;
+    }
+
+    bool operator == (RowIterator other) const {
+        return row == other.row && column == other.column;
+    }
+
+    bool operator != (RowIterator other) const {
+        return !(*this == other);
+    }
+};
+
+// Хранение и арифметика - те же, что у lecture20::Matrix, но класс самостоятельный, а не наследник:
+// так каждый вариант в сравнении описывается только своим кодом
+template <typename T, size_t N>
+class Matrix {
+private:
+    T data[N][N];
+
+public:
+    Matrix(const T& lambda = 0) {
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] = (i == j) ? lambda : 0;
+    }
+
+    T& operator() (size_t i, size_t j) {
+        return data[i][j];
+    }
+
+    const T& operator() (size_t i, size_t j) const {
+        return data[i][j];
+    }
+
+    Matrix& operator += (const Matrix& other) {
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                data[i][j] += other.data[i][j];
+        return *this;
+    }
+
+    Matrix operator + (const Matrix& other) const {
+        Matrix C(*this);
+        C += other;
+        return C;
+    }
+
+    RowIterator<T, N> begin() const {
+        return RowIterator<T, N>(this, 0, 0);
+    }
+
+    RowIterator<T, N> end() const {
+        return RowIterator<T, N>(this);
+    }
+};
+
+template <typename T, size_t N>
+Matrix<T, N> operator * (const Matrix<T, N>& A, const Matrix<T, N>& B) {
+    Matrix<T, N> C;
+    for (size_t i = 0; i != N; ++i)
+        for (size_t j = 0; j != N; ++j)
+            for (size_t k = 0; k != N; ++k)
+                C(i, j) += A(i, k) * B(k, j);
+    return C;
+}
+
+}  // namespace lecture08
+
+// 21.cpp: размер известен только во время выполнения
+namespace lecture21 {
+
+// Первый вариант из лекции: массив указателей на строки, каждая строка - отдельный блок в куче
+template <typename T>
+class RowsMatrix {
+private:
+    size_t N;
+    T ** Data;
+
+    void allocate() {
+        Data = new T * [N];
+        for (size_t i = 0; i != N; ++i)
+            Data[i] = new T [N]();
+    }
+
+public:
+    RowsMatrix(size_t n, const T& lambda = T()): N(n) {
+        allocate();
+        for (size_t i = 0; i != N; ++i)
+            Data[i][i] = lambda;
+    }
+
+    RowsMatrix(const RowsMatrix& other): N(other.N) {
+        allocate();
+        for (size_t i = 0; i != N; ++i)
+            std::copy(other.Data[i], other.Data[i] + N, Data[i]);
+    }
+
+    RowsMatrix& operator = (const RowsMatrix& other) {
+        RowsMatrix copy(other);
+        std::swap(N, copy.N);
+        std::swap(Data, copy.Data);
+        return *this;
+    }
+
+    ~RowsMatrix() {
+        for (size_t i = 0; i != N; ++i)
+            delete [] Data[i];
+        delete [] Data;
+    }
+
+    size_t size() const {
+        return N;
+    }
+
+    T * operator[] (size_t i) {
+        return Data[i];
+    }
+
+    const T * operator[] (size_t i) const {
+        return Data[i];
+    }
+};
+
+template <typename T>
+RowsMatrix<T> operator + (const RowsMatrix<T>& A, const RowsMatrix<T>& B) {
+    RowsMatrix<T> C(A);
+    for (size_t i = 0; i != C.size(); ++i)
+        for (size_t j = 0; j != C.size(); ++j)
+            C[i][j] += B[i][j];
+    return C;
+}
+
+template <typename T>
+RowsMatrix<T> operator * (const RowsMatrix<T>& A, const RowsMatrix<T>& B) {
+    RowsMatrix<T> C(A.size());
+    for (size_t i = 0; i != A.size(); ++i)
+        for (size_t j = 0; j != A.size(); ++j)
+            for (size_t k = 0; k != A.size(); ++k)
+                C[i][j] += A[i][k] * B[k][j];
+    return C;
+}
+
+// Вариант из второй половины 21.cpp (раздел про перемещение): один непрерывный блок N * N
+// и сложение, принимающее левый аргумент по значению. Умножения матриц в том разделе нет,
+// поэтому оно дописано здесь - в порядке циклов i-k-j, как operator * в 20.cpp.
+template <typename T>
+class FlatMatrix {
+private:
+    size_t N;
+    std::vector<T> Data;
+
+public:
+    FlatMatrix(size_t n, const T& lambda = T()): N(n), Data(n * n) {
+        for (size_t i = 0; i != N; ++i)
+            Data[i * N + i] = lambda;
+    }
+
+    size_t size() const {
+        return N;
+    }
+
+    T * data() {
+        return Data.data();
+    }
+
+    const T * data() const {
+        return Data.data();
+    }
+
+    T * operator[] (size_t i) {
+        return Data.data() + i * N;
+    }
+
+    const T * operator[] (size_t i) const {
+        return Data.data() + i * N;
+    }
+};
+
+template <typename T>
+FlatMatrix<T> operator + (FlatMatrix<T> A, const FlatMatrix<T>& B) {
+    T * a = A.data();
+    const T * b = B.data();
+    for (size_t k = 0; k != A.size() * A.size(); ++k)
+        a[k] += b[k];
+    return A;
+}
+
+template <typename T>
+FlatMatrix<T> operator * (const FlatMatrix<T>& A, const FlatMatrix<T>& B) {
+    const size_t N = A.size();
+    FlatMatrix<T> C(N);
+    for (size_t i = 0; i != N; ++i)
+        for (size_t k = 0; k != N; ++k) {
+            const T aik = A[i][k];
+            for (size_t j = 0; j != N; ++j)
+                C[i][j] += aik * B[k][j];
+        }
+    return C;
+}
+
+}  // namespace lecture21
@@ -176,13 +176,200 @@ Matrix<T>& operator += (
     return A;
 }
 
+// Теперь напишем обращение матрицы по-настоящему - методом Гаусса.
+// Метод Гаусса с выбором главного элемента (partial pivoting) фактически строит разложение PA = LU,
+// где P - перестановка строк, L - нижнетреугольная матрица с единицами на диагонали, U - верхнетреугольная.
+// Разложение стоит O(n^3), а каждое следующее решение системы Ax = b с готовыми L и U - всего O(n^2).
+// Поэтому разумно посчитать разложение один раз и хранить его в отдельном объекте,
+// а определитель, решения систем и обратную матрицу получать уже из него.
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+template <typename T>
+class LUDecomposition {
+private:
+    static constexpr size_t Block = 64;  // ширина блока: блок из Block строк матрицы должен помещаться в кэш процессора
+
+    size_t N;
+    std::vector<T> LU;  // L (без единичной диагонали) и U, упакованные в одну матрицу; храним её построчно в одном векторе
+    std::vector<size_t> Perm;  // Perm[i] - номер исходной строки, оказавшейся на i-м месте
+    int Sign;  // чётность перестановки: понадобится для знака определителя
+    T Tolerance;  // ведущий элемент не больше этого по модулю считаем нулём
+
+    T& at(size_t i, size_t j) {
+        return LU[i * N + j];
+    }
+
+    const T& at(size_t i, size_t j) const {
+        return LU[i * N + j];
+    }
+
+    // Для точных типов (целые, дроби, вычеты) вырожденность - это ровно нулевой ведущий элемент.
+    // В double после вычитаний точного нуля почти никогда не получается: у вырожденной матрицы
+    // на его месте остаётся "шум" порядка ошибок округления, и деление на него даёт бессмысленный ответ.
+    // Поэтому для чисел с плавающей точкой сравниваем с порогом epsilon * n * max|a_ij|.
+    bool negligible(const T& x) const {
+        using std::abs;
+        if constexpr (std::is_floating_point<T>::value)
+            return abs(x) <= Tolerance;
+        else
+            return x == T(0);
+    }
+
+    // Обычный метод Гаусса на узкой полосе столбцов [k0, k1) - "панели".
+    // Строки переставляем целиком, а вот вычитание делаем только внутри панели.
+    void factorPanel(size_t k0, size_t k1) {
+        using std::abs;
+        for (size_t k = k0; k != k1; ++k) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i != N; ++i)
+                if (abs(at(i, k)) > abs(at(pivot, k)))
+                    pivot = i;
+            if (negligible(at(pivot, k)))
+                throw ZeroDeterminantException();
+            if (pivot != k) {
+                std::swap_ranges(&at(k, 0), &at(k, 0) + N, &at(pivot, 0));
+                std::swap(Perm[k], Perm[pivot]);
+                Sign = -Sign;
+            }
+            for (size_t i = k + 1; i != N; ++i) {
+                T factor = at(i, k) /= at(k, k);
+                for (size_t j = k + 1; j != k1; ++j)
+                    at(i, j) -= factor * at(k, j);
+            }
+        }
+    }
+
+    // Применяем к b перестановку P и решаем Ly = Pb, Ux = y.
+    // Правые части лежат построчно в X (N строк по M элементов), так что все циклы идут по подряд лежащей памяти.
+    void solveInPlace(std::vector<T>& X, size_t M) const {
+        for (size_t i = 0; i != N; ++i)
+            for (size_t k = 0; k != i; ++k) {
+                const T factor = at(i, k);
+                for (size_t j = 0; j != M; ++j)
+                    X[i * M + j] -= factor * X[k * M + j];
+            }
+        for (size_t i = N; i-- != 0; ) {
+            for (size_t k = i + 1; k != N; ++k) {
+                const T factor = at(i, k);
+                for (size_t j = 0; j != M; ++j)
+                    X[i * M + j] -= factor * X[k * M + j];
+            }
+            for (size_t j = 0; j != M; ++j)
+                X[i * M + j] /= at(i, i);
+        }
+    }
+
+public:
+    // Блочный вариант метода Гаусса: обрабатываем столбцы полосами по Block штук.
+    // Для каждой полосы сначала раскладываем саму полосу, затем пересчитываем строки U справа от неё,
+    // а потом одним проходом обновляем всю оставшуюся подматрицу.
+    // Последний шаг - это умножение матриц, и строки U текущего блока при этом всё время остаются в кэше.
+    explicit LUDecomposition(const Matrix<T>& A)
+        : N(A.size())
+        , LU(N * N)
+        , Perm(N)
+        , Sign(1)
+        , Tolerance(0)
+    {
+        using std::abs;
+        for (size_t i = 0; i != N; ++i) {
+            Perm[i] = i;
+            for (size_t j = 0; j != N; ++j) {
+                at(i, j) = A(i, j);
+                if constexpr (std::is_floating_point<T>::value)
+                    Tolerance = std::max(Tolerance, abs(at(i, j)));
+            }
+        }
+        if constexpr (std::is_floating_point<T>::value)
+            Tolerance *= std::numeric_limits<T>::epsilon() * N;
+
+        for (size_t k0 = 0; k0 < N; k0 += Block) {
+            const size_t k1 = std::min(k0 + Block, N);
+            factorPanel(k0, k1);
+
+            // U12 = L11^{-1} * A12
+            for (size_t k = k0; k != k1; ++k)
+                for (size_t i = k + 1; i != k1; ++i) {
+                    const T factor = at(i, k);
+                    for (size_t j = k1; j != N; ++j)
+                        at(i, j) -= factor * at(k, j);
+                }
+
+            // A22 -= L21 * U12
+            for (size_t j0 = k1; j0 < N; j0 += 4 * Block) {
+                const size_t j1 = std::min(j0 + 4 * Block, N);
+                for (size_t i = k1; i != N; ++i)
+                    for (size_t k = k0; k != k1; ++k) {
+                        const T factor = at(i, k);
+                        for (size_t j = j0; j != j1; ++j)
+                            at(i, j) -= factor * at(k, j);
+                    }
+            }
+        }
+    }
+
+    size_t size() const {
+        return N;
+    }
+
+    T determinant() const {
+        T det = T(Sign);
+        for (size_t i = 0; i != N; ++i)
+            det *= at(i, i);
+        return det;
+    }
+
+    std::vector<T> solve(const std::vector<T>& b) const {
+        if (b.size() != N)
+            throw DifferentSizeException{N, b.size()};
+        std::vector<T> x(N);
+        for (size_t i = 0; i != N; ++i)
+            x[i] = b[Perm[i]];
+        solveInPlace(x, 1);
+        return x;
+    }
+
+    // Решаем сразу N систем: правые части - это столбцы матрицы B, решения - столбцы результата.
+    Matrix<T> solve(const Matrix<T>& B) const {
+        if (B.size() != N)
+            throw DifferentSizeException{N, B.size()};
+        std::vector<T> X(N * N);
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                X[i * N + j] = B(Perm[i], j);
+        solveInPlace(X, N);
+        Matrix<T> result(N);
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                result(i, j) = X[i * N + j];
+        return result;
+    }
+
+    Matrix<T> inverse() const {
+        Matrix<T> E(N);
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != N; ++j)
+                E(i, j) = (i == j) ? T(1) : T(0);
+        return solve(E);
+    }
+};
+
+// Если вырожденность обнаружилась при разложении, конструктор LUDecomposition сгенерирует исключение,
+// и объект разложения просто не будет создан.
+// Пользоваться разложением можно так:
+//     LUDecomposition<double> lu(A);  // O(n^3), один раз
+//     auto x1 = lu.solve(b1);  // O(n^2)
+//     auto x2 = lu.solve(b2);  // O(n^2)
+//     double det = lu.determinant();
+
 template <typename T>
 Matrix<T> inverse(const Matrix<T>& A) {
-    Matrix<T> result(A.size());
-    // Код обращения матрицы писать тут не будем - реализуйте метод Гаусса сами
-    if (/* определитель == 0 */)
-        throw ZeroDeterminantException();  // понимаете, зачем тут скобки?
-    return result;
+    // Для вырожденной матрицы здесь будет сгенерировано исключение: throw ZeroDeterminantException();
+    // (Понимаете, зачем там скобки?)
+    return LUDecomposition<T>(A).inverse();
 }
 
 
@@ -308,3 +495,949 @@ public:
 
 // Мораль: всегда предпочитайте контейнеры стандартной библиотеки низкоуровневым массивам.
 
+
+
+// ===========================
+
+// Вернёмся к нашему оператору присваивания, написанному через конструктор копирования.
+// У него есть два недостатка.
+// 1. Если матрицы A и B одного размера, то в B = A вполне можно было бы просто переписать элементы в уже имеющуюся память.
+//    Вместо этого мы выделяем новую память и освобождаем старую.
+// 2. Если справа стоит временный объект (например, B = inverse(A) или B = A + C), то глубокое копирование вообще ни к чему:
+//    временный объект всё равно сейчас умрёт, и его память можно было бы просто забрать себе.
+
+// Вторая проблема решается с помощью move-семантики (C++11).
+// Выражение inverse(A) - это rvalue, временный объект без имени. К нему можно привязать rvalue-ссылку Matrix<T>&&.
+// Если в классе есть конструктор и оператор присваивания, принимающие Matrix<T>&&, то для временных объектов
+// компилятор выберет именно их. А в них мы можем "украсть" указатель у умирающего объекта.
+// Явно переместить объект с именем можно, написав std::move(A) - это просто приведение к Matrix<T>&&.
+
+// Чтобы было удобно проверять, сколько раз выделялась память, заведём в классе статический счётчик выделений.
+// Заодно будем хранить все элементы матрицы в одном непрерывном блоке памяти: так выделение всего одно,
+// и проблем с исключениями из середины цикла выделения строк, обсуждавшихся выше, тоже нет.
+
+#include <cassert>
+#include <utility>
+
+template <typename T>
+class Matrix {
+private:
+    size_t N;  // теперь размер не может быть константой: при перемещении он меняется
+    T * Data;  // элементы матрицы построчно, N * N штук
+
+    static T * allocate(size_t n) {
+        if (n == 0)
+            return nullptr;
+        ++allocations;
+        return new T[n * n]();  // если здесь случится исключение, new[] сам освободит память
+    }
+
+public:
+    static size_t allocations;  // сколько раз выделялась память под элементы (для тестов)
+
+    Matrix(size_t n = 0, const T& lambda = T())
+        : N(n)
+        , Data(allocate(n))
+    {
+        for (size_t i = 0; i != N; ++i)
+            Data[i * N + i] = lambda;
+    }
+
+    Matrix(const Matrix& other)
+        : N(other.N)
+        , Data(allocate(other.N))
+    {
+        std::copy(other.Data, other.Data + N * N, Data);
+    }
+
+    // Конструктор перемещения: забираем память у other, а ему оставляем пустую матрицу.
+    // noexcept важен: например, std::vector при реаллокации перемещает элементы, только если перемещение не бросает исключений.
+    Matrix(Matrix&& other) noexcept
+        : N(other.N)
+        , Data(other.Data)
+    {
+        other.N = 0;
+        other.Data = nullptr;
+    }
+
+    Matrix& operator = (const Matrix& other) {
+        if (this == &other)
+            return *this;
+        if (N == other.N) {  // размеры совпадают: просто переписываем элементы в уже имеющуюся память
+            std::copy(other.Data, other.Data + N * N, Data);
+        } else {
+            Matrix copy(other);  // иначе - прежняя идиома copy-and-swap
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Matrix& operator = (Matrix&& other) noexcept {
+        swap(other);  // наша старая память уйдёт вместе с other и будет освобождена в его деструкторе
+        return *this;
+    }
+
+    ~Matrix() {
+        delete [] Data;
+    }
+
+    void swap(Matrix& other) noexcept {
+        std::swap(N, other.N);
+        std::swap(Data, other.Data);
+    }
+
+    size_t size() const {
+        return N;
+    }
+
+    T& operator () (size_t i, size_t j) {
+        return Data[i * N + j];
+    }
+
+    const T& operator () (size_t i, size_t j) const {
+        return Data[i * N + j];
+    }
+
+    T * operator[] (size_t i) {
+        return Data + i * N;
+    }
+
+    const T * operator[] (size_t i) const {
+        return Data + i * N;
+    }
+};
+
+template <typename T>
+size_t Matrix<T>::allocations = 0;
+
+// Теперь арифметические операторы могут принимать левый аргумент по значению и возвращать его же:
+// если слева стоит временный объект, его память будет переиспользована для результата.
+template <typename T>
+Matrix<T> operator + (Matrix<T> A, const Matrix<T>& B) {
+    A += B;
+    return A;  // при возврате аргумента функции сработает перемещение, а не копирование
+}
+
+// Проверим счётчиком, что лишних выделений памяти действительно нет:
+int main() {
+    typedef Matrix<double> M;
+    M A(100, 1.0), B(100, 2.0);
+    size_t before = M::allocations;
+
+    M C = A + B;  // одно выделение - копия A для аргумента; результат перемещается в C
+    assert(M::allocations == before + 1);
+
+    C = A;  // размеры совпадают: память переиспользуется
+    assert(M::allocations == before + 1);
+
+    C = A + B + B;  // одно выделение на копию A, дальше временный объект только перемещается
+    assert(M::allocations == before + 2);
+
+    M D = std::move(C);  // перемещение: ни одного выделения, C теперь пустая
+    assert(M::allocations == before + 2);
+    assert(C.size() == 0 && D.size() == 100);
+
+    M E = inverse(D);  // результат inverse перемещается (или вовсе конструируется на месте)
+    assert(E(0, 0) == 1.0 / 5.0);
+
+    M F(50);
+    F = A;  // размеры разные: выделяем новую память
+    assert(F.size() == 100);
+}
+
+
+// ===========================
+
+// Вспомним ещё одну стратегию владения памятью, упомянутую выше: подсчёт ссылок с копированием при записи (copy-on-write).
+// Копирование матрицы при этом не копирует элементы, а лишь увеличивает счётчик ссылок на общий блок памяти.
+// Настоящее ("глубокое") копирование откладывается до первой попытки изменить матрицу,
+// и происходит только если блок в этот момент действительно с кем-то разделён.
+// Это выгодно, если матрицы часто передаются по значению, но редко изменяются.
+
+// Счётчик ссылок сделаем атомарным (std::atomic): тогда копии одной матрицы можно безопасно
+// создавать и уничтожать в разных потоках одновременно.
+
+#include <atomic>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class Matrix {
+private:
+    struct Storage {  // разделяемый блок: счётчик ссылок и сами элементы
+        std::atomic<size_t> refs;
+        std::vector<T> data;
+
+        explicit Storage(size_t n): refs(1), data(n * n) {
+        }
+
+        Storage(const Storage& other): refs(1), data(other.data) {
+        }
+    };
+
+    size_t N;
+    Storage * S;
+
+    static Storage * allocate(size_t n) {
+        ++allocations;
+        return new Storage(n);
+    }
+
+    void release() noexcept {
+        // fetch_sub возвращает старое значение: если оно было 1, то мы были последним владельцем
+        if (S != nullptr && S->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete S;
+        S = nullptr;
+    }
+
+    // Перед любой модификацией: если блок разделён, делаем себе собственную копию
+    void detach() {
+        if (S != nullptr && S->refs.load(std::memory_order_acquire) != 1) {
+            ++allocations;
+            Storage * copy = new Storage(*S);  // если здесь исключение, то ничего ещё не изменилось
+            release();
+            S = copy;
+        }
+    }
+
+public:
+    static size_t allocations;
+
+    Matrix(size_t n = 0, const T& lambda = T())
+        : N(n)
+        , S(n != 0 ? allocate(n) : nullptr)
+    {
+        for (size_t i = 0; i != N; ++i)
+            S->data[i * N + i] = lambda;
+    }
+
+    Matrix(const Matrix& other) noexcept
+        : N(other.N)
+        , S(other.S)
+    {
+        if (S != nullptr)
+            S->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Matrix(Matrix&& other) noexcept
+        : N(other.N)
+        , S(other.S)
+    {
+        other.N = 0;
+        other.S = nullptr;
+    }
+
+    Matrix& operator = (Matrix other) noexcept {  // и копирующее, и перемещающее присваивание сразу
+        swap(other);
+        return *this;
+    }
+
+    ~Matrix() {
+        release();
+    }
+
+    void swap(Matrix& other) noexcept {
+        std::swap(N, other.N);
+        std::swap(S, other.S);
+    }
+
+    size_t size() const {
+        return N;
+    }
+
+    // Константные версии операторов ничего не меняют, поэтому и не копируют
+    const T& operator () (size_t i, size_t j) const {
+        return S->data[i * N + j];
+    }
+
+    const T * operator[] (size_t i) const {
+        return S->data.data() + i * N;
+    }
+
+    // А неконстантные должны сначала "отсоединиться" от общего блока
+    T& operator () (size_t i, size_t j) {
+        detach();
+        return S->data[i * N + j];
+    }
+
+    T * operator[] (size_t i) {
+        detach();
+        return S->data.data() + i * N;
+    }
+};
+
+template <typename T>
+size_t Matrix<T>::allocations = 0;
+
+// Будьте внимательны: неконстантный operator () вызывается для любой неконстантной матрицы, даже если мы только читаем.
+// Поэтому читать элементы лучше через константную ссылку на матрицу - тогда лишнего копирования не будет.
+// И ещё одна тонкость: ссылка, полученная из неконстантного operator (), остаётся указывать в наш блок.
+// Если после этого скопировать матрицу и записать что-то по старой ссылке, изменится и копия.
+// (Именно из-за таких проблем стандарт C++11 запретил реализовывать std::string с копированием при записи.)
+
+int main() {
+    typedef Matrix<double> M;
+    M A(100, 1.0);
+    size_t before = M::allocations;
+
+    M B = A, C = A;  // копирования дёшевы: память не выделяется
+    const M& ref = C;
+    double sum = ref(0, 0) + ref(1, 1);  // чтение через константную ссылку тоже не копирует
+    assert(M::allocations == before);
+
+    B(0, 0) = sum;  // первая запись в разделённую матрицу: отсоединяемся
+    assert(M::allocations == before + 1);
+    B(1, 1) = sum;  // теперь B владеет блоком единолично, копировать больше не нужно
+    assert(M::allocations == before + 1);
+
+    // Проверяемые значения читаем через std::as_const: неконстантный A(0, 0) внутри assert отсоединил бы A
+    // (а в сборке с NDEBUG - нет), и дальше копировалась бы уже не та матрица, о которой говорят комментарии
+    const bool values = std::as_const(A)(0, 0) == 1.0 && std::as_const(B)(0, 0) == 2.0;
+    assert(values);
+    assert(M::allocations == before + 1);
+
+    C[0][1] = 5;  // C делила блок только с A, но всё равно отсоединяется
+    assert(M::allocations == before + 2);
+    A(0, 1) = 7;  // а теперь A - единственный владелец исходного блока, и копии не будет
+    assert(M::allocations == before + 2);
+    const bool separated = std::as_const(A)(0, 1) == 7 && std::as_const(C)(0, 1) == 5 && std::as_const(B)(0, 1) == 0.0;
+    assert(separated);
+}
+
+
+// ===========================
+
+// Бывает, что почти все элементы матрицы равны нулю (например, матрица смежности большого графа
+// или матрица системы уравнений, полученной из разностной схемы).
+// Тогда хранить N * N элементов расточительно: достаточно хранить только ненулевые.
+
+// Есть два популярных формата.
+// COO (coordinate list) - просто список троек (строка, столбец, значение) в произвольном порядке.
+// В него удобно добавлять элементы, но искать в нём медленно.
+// CSR (compressed sparse row) - ненулевые элементы, упорядоченные по строкам, в двух массивах:
+// Columns[k] и Values[k] - столбец и значение k-го ненулевого элемента, а RowStart[i] - номер первого элемента i-й строки.
+// Элементы i-й строки лежат в позициях от RowStart[i] до RowStart[i + 1]. Это компактно и быстро для умножения.
+
+// Наш класс будет накапливать изменения в формате COO и переводить их в CSR методом compress().
+// Делать это лениво внутри константных методов (при первом чтении) было бы удобно, но тогда константный метод
+// меняет объект, и два потока, одновременно читающие одну матрицу, испортили бы друг другу CSR.
+// Поэтому константные методы только читают и требуют, чтобы неучтённых изменений не было:
+// после построения матрицы нужно один раз вызвать compress(), а дальше читать её можно из скольких угодно потоков.
+// Доступ к элементам - тот же, что и у плотной матрицы: A(i, j).
+// Только неконстантный operator () не может вернуть T& (нулевого элемента в памяти просто нет),
+// поэтому он возвращает объект-посредник (proxy), который перехватывает присваивание.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+class IndexOutOfRangeException {  // Тип исключения для обращения к элементу за пределами матрицы
+public:
+    size_t Row, Column;  // индексы, по которым обратились
+    size_t N;  // размер матрицы
+};
+
+class PendingChangesException {  // Тип исключения для чтения через константный метод до вызова compress()
+public:
+    size_t Pending;  // сколько изменений ещё не переведено в CSR
+};
+
+template <typename T>
+class SparseMatrix {
+private:
+    struct Entry {  // отложенная запись в формате COO
+        size_t row, column;
+        T value;
+        bool accumulate;  // true - прибавить value к элементу, false - записать value в элемент
+    };
+
+    size_t N;
+    std::vector<Entry> Pending;  // ещё не учтённые изменения
+    std::vector<size_t> RowStart, Columns;  // CSR
+    std::vector<T> Values;
+
+    // SpMV на матрицах меньше этого числа ненулевых элементов считаем в одном потоке: потоки не окупаются
+    static const size_t MinParallelNonZeros = 100000;
+
+    void requireCompressed() const {
+        if (!Pending.empty())
+            throw PendingChangesException{Pending.size()};
+    }
+
+    // Ищем элемент (i, j) в CSR двоичным поиском внутри строки. Возвращаем -1, если его там нет.
+    std::ptrdiff_t find(size_t i, size_t j) const {
+        auto first = Columns.begin() + RowStart[i];
+        auto last = Columns.begin() + RowStart[i + 1];
+        auto it = std::lower_bound(first, last, j);
+        if (it == last || *it != j)
+            return -1;
+        return it - Columns.begin();
+    }
+
+public:
+    class Reference {  // тот самый посредник для A(i, j) = x
+    private:
+        SparseMatrix& matrix;
+        size_t row, column;
+    public:
+        Reference(SparseMatrix& m, size_t i, size_t j): matrix(m), row(i), column(j) {
+        }
+
+        // Через неконстантную матрицу читать можно и до compress(): посредник сам переведёт изменения в CSR
+        operator T () const {
+            matrix.compress();
+            return static_cast<const SparseMatrix&>(matrix)(row, column);
+        }
+
+        Reference& operator = (const T& value) {
+            matrix.set(row, column, value, false);
+            return *this;
+        }
+
+        Reference& operator += (const T& value) {
+            matrix.set(row, column, value, true);
+            return *this;
+        }
+    };
+
+    explicit SparseMatrix(size_t n): N(n), RowStart(n + 1, 0) {
+    }
+
+    // Перевод из плотной матрицы: сохраняем только ненулевые элементы
+    explicit SparseMatrix(const Matrix<T>& dense): SparseMatrix(dense.size()) {
+        const Matrix<T>& A = dense;
+        for (size_t i = 0; i != N; ++i) {
+            for (size_t j = 0; j != N; ++j)
+                if (A(i, j) != T(0)) {
+                    Columns.push_back(j);
+                    Values.push_back(A(i, j));
+                }
+            RowStart[i + 1] = Columns.size();
+        }
+    }
+
+    size_t size() const {
+        return N;
+    }
+
+    size_t nonZeros() const {
+        requireCompressed();
+        return Values.size();
+    }
+
+    // Сколько байт занимают данные (для сравнения с N * N * sizeof(T) у плотной матрицы)
+    size_t memoryBytes() const {
+        requireCompressed();
+        return RowStart.size() * sizeof(size_t) + Columns.size() * sizeof(size_t) + Values.size() * sizeof(T);
+    }
+
+    // Построение в формате COO: дешёвое добавление в конец списка, без поиска
+    void set(size_t i, size_t j, const T& value, bool accumulate = false) {
+        if (i >= N || j >= N)
+            throw IndexOutOfRangeException{i, j, N};
+        if (Pending.empty()) {  // если элемент уже есть в CSR, его можно поменять на месте
+            const std::ptrdiff_t k = find(i, j);
+            if (k >= 0) {
+                const T result = accumulate ? Values[k] + value : value;
+                if (result != T(0)) {
+                    Values[k] = result;
+                    return;
+                }
+                // А вот ноль на месте оставлять нельзя: в CSR хранятся только ненулевые элементы.
+                // Отправляем запись в Pending - compress() выбросит элемент из CSR.
+            }
+        }
+        Pending.push_back(Entry{i, j, value, accumulate});
+    }
+
+    void add(size_t i, size_t j, const T& value) {
+        set(i, j, value, true);
+    }
+
+    // Перевод накопленных изменений в CSR: сортируем их, сливаем с уже имеющимися элементами
+    // и выбрасываем оказавшиеся нулевыми. Всё это - за O(nnz log nnz).
+    void compress() {
+        if (Pending.empty())
+            return;
+        // stable_sort сохраняет порядок записей в одну и ту же клетку: последняя запись должна победить
+        std::stable_sort(Pending.begin(), Pending.end(), [](const Entry& a, const Entry& b) {
+            return a.row < b.row || (a.row == b.row && a.column < b.column);
+        });
+
+        std::vector<size_t> newRowStart(N + 1, 0), newColumns;
+        std::vector<T> newValues;
+        newColumns.reserve(Columns.size() + Pending.size());
+        newValues.reserve(Values.size() + Pending.size());
+
+        size_t p = 0;
+        for (size_t i = 0; i != N; ++i) {
+            size_t k = RowStart[i];
+            const size_t rowEnd = RowStart[i + 1];
+            while (k != rowEnd || (p != Pending.size() && Pending[p].row == i)) {
+                size_t j;
+                T value = T(0);
+                bool pendingHere = p != Pending.size() && Pending[p].row == i;
+                if (k != rowEnd && (!pendingHere || Columns[k] <= Pending[p].column)) {
+                    j = Columns[k];
+                    value = Values[k++];
+                } else {
+                    j = Pending[p].column;
+                }
+                for (; p != Pending.size() && Pending[p].row == i && Pending[p].column == j; ++p) {
+                    if (Pending[p].accumulate)
+                        value += Pending[p].value;
+                    else
+                        value = Pending[p].value;
+                }
+                if (value != T(0)) {
+                    newColumns.push_back(j);
+                    newValues.push_back(value);
+                }
+            }
+            newRowStart[i + 1] = newColumns.size();
+        }
+
+        RowStart.swap(newRowStart);
+        Columns.swap(newColumns);
+        Values.swap(newValues);
+        Pending.clear();
+    }
+
+    T operator () (size_t i, size_t j) const {
+        requireCompressed();
+        const std::ptrdiff_t k = find(i, j);
+        return k >= 0 ? Values[k] : T(0);
+    }
+
+    Reference operator () (size_t i, size_t j) {
+        return Reference(*this, i, j);
+    }
+
+    Matrix<T> toDense() const {
+        requireCompressed();
+        Matrix<T> result(N);
+        for (size_t i = 0; i != N; ++i) {
+            T * row = result[i];
+            for (size_t k = RowStart[i]; k != RowStart[i + 1]; ++k)
+                row[Columns[k]] = Values[k];
+        }
+        return result;
+    }
+
+    // Обход всех ненулевых элементов по строкам: f(i, j, value)
+    template <typename Function>
+    void forEachNonZero(Function f) const {
+        requireCompressed();
+        for (size_t i = 0; i != N; ++i)
+            for (size_t k = RowStart[i]; k != RowStart[i + 1]; ++k)
+                f(i, Columns[k], Values[k]);
+    }
+
+    // Умножение на вектор (SpMV) в несколько потоков.
+    // Строки делим между потоками так, чтобы на каждый пришлось примерно поровну ненулевых элементов:
+    // RowStart как раз позволяет найти такие границы двоичным поиском.
+    // Каждый поток пишет только в свой кусок результата, так что синхронизация не нужна.
+    std::vector<T> multiply(const std::vector<T>& x, size_t threads = std::thread::hardware_concurrency()) const {
+        if (x.size() != N)
+            throw DifferentSizeException{N, x.size()};
+        requireCompressed();  // потоки только читают CSR
+        std::vector<T> y(N);
+        auto work = [&](size_t firstRow, size_t lastRow) {
+            for (size_t i = firstRow; i != lastRow; ++i) {
+                T sum = T(0);
+                for (size_t k = RowStart[i]; k != RowStart[i + 1]; ++k)
+                    sum += Values[k] * x[Columns[k]];
+                y[i] = sum;
+            }
+        };
+
+        threads = std::max<size_t>(1, std::min(threads, N));
+        if (threads == 1 || Values.size() < MinParallelNonZeros) {
+            work(0, N);
+            return y;
+        }
+        std::vector<std::thread> pool;
+        size_t firstRow = 0;
+        for (size_t t = 1; t <= threads; ++t) {
+            size_t lastRow = N;
+            if (t != threads) {
+                size_t target = Values.size() * t / threads;
+                lastRow = std::lower_bound(RowStart.begin(), RowStart.end(), target) - RowStart.begin();
+                lastRow = std::max(lastRow, firstRow);
+            }
+            pool.emplace_back(work, firstRow, lastRow);
+            firstRow = lastRow;
+        }
+        for (auto& thread : pool)
+            thread.join();
+        return y;
+    }
+};
+
+// Произведение разреженной матрицы на плотную.
+// i-я строка результата - это сумма строк B, взятых с коэффициентами из i-й строки A.
+// Перебираем только ненулевые элементы A, а строки B и C проходим подряд по памяти.
+template <typename T>
+Matrix<T> operator * (const SparseMatrix<T>& A, const Matrix<T>& B) {
+    if (A.size() != B.size())
+        throw DifferentSizeException{A.size(), B.size()};
+    const size_t N = A.size();
+    const Matrix<T>& b = B;  // константная ссылка: читаем B без копирования
+    Matrix<T> C(N);
+    A.forEachNonZero([&](size_t i, size_t k, const T& value) {
+        T * crow = C[i];
+        const T * brow = b[k];
+        for (size_t j = 0; j != N; ++j)
+            crow[j] += value * brow[j];
+    });
+    return C;
+}
+
+// Сравним плотное и разреженное представления трёхдиагональной матрицы размера 3000 x 3000
+int main() {
+    const size_t n = 3000;
+    SparseMatrix<double> S(n);
+    for (size_t i = 0; i != n; ++i) {
+        S(i, i) = 2;
+        if (i > 0)
+            S.add(i, i - 1, -1);
+        if (i + 1 < n)
+            S.add(i, i + 1, -1);
+    }
+    S.compress();  // построение закончено: дальше матрицу только читаем
+    Matrix<double> D = S.toDense();
+
+    std::cout << "dense: " << n * n * sizeof(double) << " bytes, "
+              << "sparse: " << S.memoryBytes() << " bytes (" << S.nonZeros() << " non-zeros)\n";
+
+    std::vector<double> x(n, 1.0), y(n);
+    auto start = std::chrono::steady_clock::now();
+    const Matrix<double>& d = D;
+    for (size_t i = 0; i != n; ++i) {
+        double sum = 0;
+        for (size_t j = 0; j != n; ++j)
+            sum += d(i, j) * x[j];
+        y[i] = sum;
+    }
+    auto middle = std::chrono::steady_clock::now();
+    auto z = S.multiply(x);
+    auto finish = std::chrono::steady_clock::now();
+
+    std::cout << "dense mat-vec: " << std::chrono::duration<double, std::micro>(middle - start).count() << " us, "
+              << "sparse: " << std::chrono::duration<double, std::micro>(finish - middle).count() << " us\n";
+    std::cout << "same result: " << (y == z) << "\n";
+
+    // У этой матрицы всего 9000 ненулевых элементов, и SpMV считается в одном потоке.
+    // Чтобы сравнить с многопоточным умножением, построим трёхдиагональную матрицу побольше:
+    // плотную такую уже не сравнить (N * N чисел не поместятся в память), поэтому сравниваем 1 поток и несколько.
+    const size_t big = 1000000;
+    SparseMatrix<double> L(big);
+    for (size_t i = 0; i != big; ++i) {
+        L(i, i) = 2;
+        if (i > 0)
+            L.add(i, i - 1, -1);
+        if (i + 1 < big)
+            L.add(i, i + 1, -1);
+    }
+    L.compress();
+    const size_t threads = std::max(4u, std::thread::hardware_concurrency());
+    std::vector<double> u(big, 1.0);
+    start = std::chrono::steady_clock::now();
+    auto serial = L.multiply(u, 1);
+    middle = std::chrono::steady_clock::now();
+    auto parallel = L.multiply(u, threads);
+    finish = std::chrono::steady_clock::now();
+    std::cout << L.nonZeros() << " non-zeros: 1 thread " << std::chrono::duration<double, std::micro>(middle - start).count()
+              << " us, " << threads << " threads " << std::chrono::duration<double, std::micro>(finish - middle).count()
+              << " us (cores: " << std::thread::hardware_concurrency() << "), same result: " << (serial == parallel) << "\n";
+}
+
+
+// ===========================
+
+// Вернёмся к матрице с move-семантикой (она хранила элементы в одном блоке памяти).
+// Если программа в цикле создаёт и уничтожает много короткоживущих матриц (промежуточные результаты вычислений),
+// то каждое создание - это вызов new, а каждое уничтожение - вызов delete.
+// Глобальная куча - общий ресурс: в многопоточной программе потоки ещё и конкурируют за неё.
+
+// Стандартные контейнеры решают эту проблему так: способ выделения памяти - это шаблонный параметр, аллокатор.
+// По умолчанию это std::allocator<T> (то есть, обычные new и delete), но его можно заменить своим.
+// Сделаем так же. С аллокатором работаем через std::allocator_traits: они дописывают за нас всё,
+// чего в конкретном аллокаторе нет (например, construct и destroy).
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+template <typename T, typename Allocator = std::allocator<T>>
+class Matrix {
+private:
+    typedef std::allocator_traits<Allocator> Traits;
+
+    Allocator Alloc;
+    size_t N;
+    T * Data;
+
+    // Выделяем память и конструируем n * n элементов; при исключении всё откатываем
+    template <typename Init>
+    T * create(size_t n, Init init) {
+        if (n == 0)
+            return nullptr;
+        ++allocations;
+        T * p = Traits::allocate(Alloc, n * n);
+        size_t constructed = 0;
+        try {
+            for (; constructed != n * n; ++constructed)
+                init(p + constructed, constructed);
+        } catch (...) {
+            while (constructed != 0)
+                Traits::destroy(Alloc, p + --constructed);
+            Traits::deallocate(Alloc, p, n * n);
+            throw;
+        }
+        return p;
+    }
+
+    void destroy() noexcept {
+        if (Data == nullptr)
+            return;
+        for (size_t k = 0; k != N * N; ++k)
+            Traits::destroy(Alloc, Data + k);
+        Traits::deallocate(Alloc, Data, N * N);
+        Data = nullptr;
+    }
+
+public:
+    static std::atomic<size_t> allocations;  // матрицы создаются в разных потоках, поэтому счётчик атомарный
+
+    explicit Matrix(size_t n = 0, const T& lambda = T(), const Allocator& alloc = Allocator())
+        : Alloc(alloc)
+        , N(n)
+        , Data(create(n, [&](T * p, size_t k) {
+            Traits::construct(Alloc, p, k % (n + 1) == 0 ? lambda : T());  // на диагонали стоят элементы с номерами k = i * (n + 1)
+        }))
+    {
+    }
+
+    Matrix(const Matrix& other)
+        : Alloc(Traits::select_on_container_copy_construction(other.Alloc))
+        , N(other.N)
+        , Data(create(other.N, [&](T * p, size_t k) {
+            Traits::construct(Alloc, p, other.Data[k]);
+        }))
+    {
+    }
+
+    Matrix(Matrix&& other) noexcept
+        : Alloc(std::move(other.Alloc))
+        , N(other.N)
+        , Data(other.Data)
+    {
+        other.N = 0;
+        other.Data = nullptr;
+    }
+
+    // Для простоты считаем, что все аллокаторы одного типа взаимозаменяемы (так и есть у std::allocator и у пула ниже)
+    Matrix& operator = (const Matrix& other) {
+        if (this == &other)
+            return *this;
+        if (N == other.N) {
+            std::copy(other.Data, other.Data + N * N, Data);
+        } else {
+            Matrix copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Matrix& operator = (Matrix&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~Matrix() {
+        destroy();
+    }
+
+    void swap(Matrix& other) noexcept {
+        std::swap(Alloc, other.Alloc);
+        std::swap(N, other.N);
+        std::swap(Data, other.Data);
+    }
+
+    size_t size() const {
+        return N;
+    }
+
+    T& operator () (size_t i, size_t j) {
+        return Data[i * N + j];
+    }
+
+    const T& operator () (size_t i, size_t j) const {
+        return Data[i * N + j];
+    }
+
+    T * operator[] (size_t i) {
+        return Data + i * N;
+    }
+
+    const T * operator[] (size_t i) const {
+        return Data + i * N;
+    }
+};
+
+template <typename T, typename Allocator>
+std::atomic<size_t> Matrix<T, Allocator>::allocations(0);
+
+// Теперь сам пул.
+// У каждого потока (thread_local) есть свой набор списков свободных блоков - по одному списку на каждый размер.
+// При освобождении блок не возвращается в кучу, а кладётся в список; при следующем запросе того же размера
+// он достаётся оттуда. Матрицы-"черновики" одного размера, создаваемые на каждой итерации, переиспользуют одни и те же блоки,
+// а потоки вообще не трогают общую кучу и не мешают друг другу.
+// Блок, освобождённый в другом потоке, просто попадёт в пул этого другого потока - это корректно.
+
+class MatrixPool {
+private:
+    static const size_t MaxFreeBlocks = 64;  // сколько блоков одного размера храним про запас
+
+    struct FreeList {
+        size_t bytes;
+        std::vector<void *> blocks;
+    };
+    // Разных размеров матриц в программе обычно немного, поэтому простой линейный поиск
+    // по короткому вектору быстрее хеш-таблицы
+    std::vector<FreeList> FreeLists;
+
+    std::vector<void *>& listFor(size_t bytes) {
+        for (auto& list : FreeLists)
+            if (list.bytes == bytes)
+                return list.blocks;
+        FreeLists.push_back(FreeList{bytes, {}});
+        return FreeLists.back().blocks;
+    }
+
+public:
+    size_t heapAllocations = 0;  // сколько раз пул этого потока обратился к глобальной куче
+    static std::atomic<size_t> totalHeapAllocations;  // то же по всем потокам, включая уже завершившиеся
+
+    MatrixPool() = default;
+    MatrixPool(const MatrixPool&) = delete;
+    MatrixPool& operator = (const MatrixPool&) = delete;
+
+    ~MatrixPool() {
+        for (auto& list : FreeLists)
+            for (void * p : list.blocks)
+                ::operator delete(p);
+    }
+
+    void * allocate(size_t bytes) {
+        auto& list = listFor(bytes);
+        if (!list.empty()) {
+            void * p = list.back();
+            list.pop_back();
+            return p;
+        }
+        ++heapAllocations;
+        ++totalHeapAllocations;  // медленный путь и так идёт в кучу, атомарное увеличение на его фоне незаметно
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void * p, size_t bytes) {
+        auto& list = listFor(bytes);
+        if (list.size() < MaxFreeBlocks)
+            list.push_back(p);
+        else
+            ::operator delete(p);
+    }
+
+    static MatrixPool& local() {
+        thread_local MatrixPool pool;
+        return pool;
+    }
+};
+
+std::atomic<size_t> MatrixPool::totalHeapAllocations(0);
+
+// Сам аллокатор ничего не хранит: он лишь перенаправляет запросы в пул текущего потока
+template <typename T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+
+    PoolAllocator() = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {
+    }
+
+    T * allocate(size_t n) {
+        return static_cast<T *>(MatrixPool::local().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T * p, size_t n) {
+        MatrixPool::local().deallocate(p, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator == (const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator != (const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return false;
+}
+
+// Замерим типичную итерацию: несколько матриц-черновиков, которые живут внутри одной итерации цикла.
+// Запускаем одно и то же в нескольких потоках - сначала с std::allocator, потом с пулом.
+template <typename Allocator>
+double iterate(size_t threads, size_t iterations, size_t n) {
+    typedef Matrix<double, Allocator> M;
+    auto work = [=] {
+        M accumulator(n, 1.0);
+        for (size_t it = 0; it != iterations; ++it) {
+            M scratch(n, 2.0);
+            M copy = scratch;
+            copy(0, 0) += accumulator(0, 0);
+            accumulator = std::move(copy);
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t != threads; ++t)
+        pool.emplace_back(work);
+    for (auto& thread : pool)
+        thread.join();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const size_t threads = 4, iterations = 100000, n = 8;
+    double plain = iterate<std::allocator<double>>(threads, iterations, n);
+    const size_t heapBefore = MatrixPool::totalHeapAllocations;
+    double pooled = iterate<PoolAllocator<double>>(threads, iterations, n);
+    std::cout << "std::allocator: " << plain << " ms, "
+              << Matrix<double>::allocations << " matrix allocations, all of them from the heap\n";
+    std::cout << "PoolAllocator: " << pooled << " ms, "
+              << Matrix<double, PoolAllocator<double>>::allocations << " matrix allocations, "
+              << MatrixPool::totalHeapAllocations - heapBefore << " of them from the heap\n";
+
+    // Внутри одного потока пул обращается к куче лишь несколько раз - за первыми блоками
+    size_t before = MatrixPool::local().heapAllocations;
+    {
+        Matrix<double, PoolAllocator<double>> A(n), B(n);
+        for (size_t it = 0; it != 1000; ++it) {
+            Matrix<double, PoolAllocator<double>> scratch(A);
+            B = std::move(scratch);
+        }
+    }
+    std::cout << "heap allocations in this thread for 1002 pooled matrices: "
+              << MatrixPool::local().heapAllocations - before << "\n";
+}
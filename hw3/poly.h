@@ -0,0 +1,1981 @@
+#pragma once
+
+// Многочлены от одной переменной (задача A1).
+//
+// Коэффициенты хранятся в векторе, начиная с младшей степени: coefficients[i] - коэффициент при x^i.
+// Старший коэффициент всегда ненулевой, у нулевого многочлена вектор пуст, а степень равна -1.
+//
+// Умножение выбирает алгоритм по размеру множителей (см. polynomial_kernels::multiply):
+//   * школьное умножение за O(n m) - для коротких многочленов;
+//   * алгоритм Карацубы за O(n^1.58) - для средних и для типов, у которых нет быстрого преобразования;
+//   * теоретико-числовое преобразование (NTT) за O(n log n) - для целых чисел и вычетов ModInt:
+//     считаем по трём простым модулям и восстанавливаем ответ по китайской теореме об остатках,
+//     так что результат в точности совпадает со школьным умножением;
+//   * быстрое преобразование Фурье (FFT) над комплексными числами - для float и double (с погрешностью округления).
+// Пороги переключения подобраны по poly_bench.cpp.
+//
+// Деление длинных многочленов над полем сводится к умножению: 1 / b как степенной ряд считается методом Ньютона,
+// а НОД над полем (например, ModInt) - алгоритмом half-gcd, который проходит половину шагов Евклида
+// по старшим коэффициентам.
+// Значения во многих точках считаются схемой Горнера сразу для нескольких точек, а для очень больших
+// многочлена и набора точек над полем - спуском по дереву подпроизведений.
+//
+// SparsePolynomial (задача A2) хранит только ненулевые члены, так что все операции стоят
+// по числу членов, а не по степени.
+// MultivariatePolynomial (задача A3) устроен так же, но ключ члена - вектор степеней, упакованный в одно
+// 64-битное число (см. MonomialPacking): сравнение и умножение одночленов - это сравнение и сложение чисел.
+// Большие произведения считаются в несколько потоков.
+//
+// Fraction (задача A4) - частное двух многочленов; на НОД сокращается лениво (см. комментарий к классу).
+//
+// FixedPolynomial - многочлен с коэффициентами, известными при компиляции (например, приближение функции):
+// все операции constexpr, а значение считается по схеме Эстрина без циклов.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class ZeroDivisionException {  // деление на нулевой многочлен
+};
+
+class MonomialOverflowException {  // степень не помещается в поле упакованного одночлена
+};
+
+namespace polynomial_kernels {
+
+// Вычеты: тип с константой T::Modulus и методом get() (например, ModInt из 2019-1/modint.h)
+template <typename T, typename = void>
+struct HasModulus : std::false_type {
+};
+
+template <typename T>
+struct HasModulus<T, std::void_t<decltype(T::Modulus), decltype(std::declval<T>().get())>> : std::true_type {
+};
+
+// Пороги - по длине меньшего из множителей; подобраны по замерам poly_bench thresholds.
+// Для встроенных типов и вычетов наивное умножение векторизуется (см. addScaled: в умножении ModInt
+// по Монтгомери нет деления) и обгоняет Карацубу гораздо дольше, чем для прочих типов вроде Fraction.
+template <typename T>
+constexpr size_t karatsubaThreshold() {
+    if constexpr (std::is_arithmetic<T>::value)
+        return 256;
+    else if constexpr (HasModulus<T>::value)
+        return 128;
+    else
+        return 32;
+}
+
+// out[0 .. n) += a * b[0 .. n).
+// При -O2 GCC векторизует только циклы с известным числом итераций и без проверок на перекрытие массивов,
+// поэтому идём порциями по Lanes элементов через __restrict-указатели (как matrix_kernels::addScaledRow).
+template <typename T>
+inline void addScaled(T * __restrict out, const T * __restrict b, T a, size_t n) {
+    const size_t Lanes = 16;
+    size_t j = 0;
+    for (; j + Lanes <= n; j += Lanes)
+        for (size_t t = 0; t != Lanes; ++t)
+            out[j + t] += a * b[j + t];
+    for (; j != n; ++j)
+        out[j] += a * b[j];
+}
+
+// Все функции ниже прибавляют произведение к out, где заранее выделено n + m - 1 элементов
+template <typename T>
+void addProductSchoolbook(const T * a, size_t n, const T * b, size_t m, T * out) {
+    for (size_t i = 0; i != n; ++i)
+        addScaled(out + i, b, a[i], m);
+}
+
+// Карацуба для множителей одинаковой длины n.
+// Делим a = a0 + a1 x^h, b = b0 + b1 x^h и вместо четырёх произведений половин считаем три:
+// a0 b0, a1 b1 и (a0 + a1)(b0 + b1), из которого вычитаем первые два.
+template <typename T>
+void addProductKaratsuba(const T * a, const T * b, size_t n, T * out) {
+    if (n < karatsubaThreshold<T>()) {
+        addProductSchoolbook(a, n, b, n, out);
+        return;
+    }
+    const size_t h = n / 2;
+    const size_t g = n - h;  // длина старших половин, g >= h
+
+    std::vector<T> low(2 * h - 1, T(0)), high(2 * g - 1, T(0)), middle(2 * g - 1, T(0));
+    std::vector<T> sumA(a + h, a + n), sumB(b + h, b + n);
+    for (size_t i = 0; i != h; ++i) {
+        sumA[i] += a[i];
+        sumB[i] += b[i];
+    }
+    addProductKaratsuba(a, b, h, low.data());
+    addProductKaratsuba(a + h, b + h, g, high.data());
+    addProductKaratsuba(sumA.data(), sumB.data(), g, middle.data());
+
+    for (size_t i = 0; i != low.size(); ++i)
+        middle[i] -= low[i];
+    for (size_t i = 0; i != high.size(); ++i)
+        middle[i] -= high[i];
+    for (size_t i = 0; i != low.size(); ++i)
+        out[i] += low[i];
+    for (size_t i = 0; i != middle.size(); ++i)
+        out[h + i] += middle[i];
+    for (size_t i = 0; i != high.size(); ++i)
+        out[2 * h + i] += high[i];
+}
+
+// Множители разной длины: режем длинный на куски длины короткого
+template <typename T>
+void addProductUnbalanced(const T * a, size_t n, const T * b, size_t m, T * out) {
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m < karatsubaThreshold<T>()) {
+        addProductSchoolbook(a, n, b, m, out);
+        return;
+    }
+    size_t start = 0;
+    for (; start + m <= n; start += m)
+        addProductKaratsuba(a + start, b, m, out + start);
+    if (start != n)
+        addProductUnbalanced(a + start, n - start, b, m, out + start);
+}
+
+// Теоретико-числовое преобразование по простому модулю Mod = c * 2^k + 1 с первообразным корнем 3.
+// Это то же БПФ, только корни из единицы берутся не комплексные, а по модулю Mod.
+template <uint32_t Mod>
+class NumberTheoreticTransform {
+private:
+    static uint32_t multiply(uint32_t a, uint32_t b) {
+        return static_cast<uint64_t>(a) * b % Mod;
+    }
+
+public:
+    static uint32_t power(uint32_t base, uint64_t n) {
+        uint32_t result = 1;
+        for (; n != 0; n /= 2) {
+            if (n % 2 != 0)
+                result = multiply(result, base);
+            base = multiply(base, base);
+        }
+        return result;
+    }
+
+    // Размер a - степень двойки. Итеративный алгоритм Кули-Тьюки с предварительной перестановкой элементов.
+    static void transform(std::vector<uint32_t>& a, bool inverse) {
+        const size_t n = a.size();
+        for (size_t i = 1, j = 0; i != n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j)
+                std::swap(a[i], a[j]);
+        }
+
+        std::vector<uint32_t> roots;
+        for (size_t length = 2; length <= n; length *= 2) {
+            uint32_t root = power(3, (Mod - 1) / length);
+            if (inverse)
+                root = power(root, Mod - 2);
+            roots.assign(length / 2, 1);
+            for (size_t k = 1; k < length / 2; ++k)
+                roots[k] = multiply(roots[k - 1], root);
+
+            for (size_t start = 0; start != n; start += length) {
+                uint32_t * left = a.data() + start;
+                uint32_t * right = left + length / 2;
+                for (size_t k = 0; k != length / 2; ++k) {
+                    const uint32_t u = left[k];
+                    const uint32_t v = multiply(right[k], roots[k]);
+                    left[k] = u + v < Mod ? u + v : u + v - Mod;
+                    right[k] = u >= v ? u - v : u + Mod - v;
+                }
+            }
+        }
+
+        if (inverse) {
+            const uint32_t scale = power(n, Mod - 2);
+            for (auto& x : a)
+                x = multiply(x, scale);
+        }
+    }
+
+    // Свёртка векторов вычетов; size - длина результата
+    static std::vector<uint32_t> convolve(std::vector<uint32_t> a, std::vector<uint32_t> b, size_t size) {
+        size_t n = 1;
+        while (n < size)
+            n *= 2;
+        a.resize(n);
+        b.resize(n);
+        transform(a, false);
+        transform(b, false);
+        for (size_t i = 0; i != n; ++i)
+            a[i] = multiply(a[i], b[i]);
+        transform(a, true);
+        a.resize(size);
+        return a;
+    }
+};
+
+// Три простых модуля вида c * 2^k + 1 (k >= 23, то есть длины до 8 миллионов коэффициентов).
+// Их произведение - около 2^86: любой коэффициент, который меньше по модулю половины этого числа,
+// однозначно восстанавливается по трём остаткам.
+const uint32_t Prime1 = 998244353, Prime2 = 167772161, Prime3 = 469762049;
+const size_t MaxTransformLength = size_t(1) << 23;
+
+typedef __int128 Wide;  // расширение GCC и Clang: 128-битное целое
+
+inline Wide productOfPrimes() {
+    return Wide(Prime1) * Prime2 * Prime3;
+}
+
+// Свёртка целых чисел по трём модулям. Входные числа задаются остатками: residue(i, prime).
+// Возвращает точные значения коэффициентов, если они по модулю меньше productOfPrimes() / 2.
+template <typename Residue>
+std::vector<Wide> convolveExact(size_t n, size_t m, Residue residueA, Residue residueB) {
+    const size_t size = n + m - 1;
+    auto convolveModulo = [&](auto transform, uint32_t prime) {
+        std::vector<uint32_t> a(n), b(m);
+        for (size_t i = 0; i != n; ++i)
+            a[i] = residueA(i, prime);
+        for (size_t i = 0; i != m; ++i)
+            b[i] = residueB(i, prime);
+        return transform.convolve(std::move(a), std::move(b), size);
+    };
+    const auto r1 = convolveModulo(NumberTheoreticTransform<Prime1>(), Prime1);
+    const auto r2 = convolveModulo(NumberTheoreticTransform<Prime2>(), Prime2);
+    const auto r3 = convolveModulo(NumberTheoreticTransform<Prime3>(), Prime3);
+
+    // Алгоритм Гарнера: x = r1 + p1 k2 + p1 p2 k3, где k2 < p2 и k3 < p3
+    const uint64_t inverse12 = NumberTheoreticTransform<Prime2>::power(Prime1 % Prime2, Prime2 - 2);
+    const uint64_t p12 = uint64_t(Prime1) * Prime2;
+    const uint64_t inverse123 = NumberTheoreticTransform<Prime3>::power(p12 % Prime3, Prime3 - 2);
+    const Wide total = productOfPrimes();
+
+    std::vector<Wide> result(size);
+    for (size_t i = 0; i != size; ++i) {
+        const uint64_t k2 = (r2[i] + Prime2 - r1[i] % Prime2) % Prime2 * inverse12 % Prime2;
+        const uint64_t x12 = r1[i] + uint64_t(Prime1) * k2;
+        const uint64_t k3 = (r3[i] + Prime3 - x12 % Prime3) % Prime3 * inverse123 % Prime3;
+        Wide x = Wide(x12) + Wide(p12) * k3;
+        if (x > total / 2)  // отрицательные числа восстанавливаются как x - p1 p2 p3
+            x -= total;
+        result[i] = x;
+    }
+    return result;
+}
+
+// Корни из единицы для БПФ: root[half + k] = exp(i pi k / half) для каждого уровня half = 1, 2, 4, ...
+// Считаем их напрямую через cos и sin, а не домножением, чтобы ошибка округления не накапливалась.
+// Значения на уровне не зависят от длины преобразования, поэтому таблица только растёт;
+// она своя у каждого потока, так что умножать многочлены можно из нескольких потоков одновременно.
+struct FftRoots {
+    std::vector<double> re = {0.0}, im = {0.0};
+
+    void reserve(size_t n) {
+        const double pi = std::acos(-1.0);
+        for (size_t half = re.size(); half < n; half *= 2) {
+            re.resize(2 * half);
+            im.resize(2 * half);
+            for (size_t k = 0; k != half; ++k) {
+                re[half + k] = std::cos(pi / half * k);
+                im[half + k] = std::sin(pi / half * k);
+            }
+        }
+    }
+};
+
+// БПФ над комплексными числами. Действительные и мнимые части храним в отдельных массивах:
+// с массивом std::complex<double> GCC при -O2 собирает медленный векторный код, а здесь внутренний цикл -
+// простые поэлементные операции над непересекающимися массивами.
+// Обратное преобразование сводится к прямому: fft^-1(x) = conj(fft(conj(x))) / n.
+inline void fft(std::vector<double>& re, std::vector<double>& im, bool inverse) {
+    const size_t n = re.size();
+    thread_local FftRoots roots;
+    roots.reserve(n);
+
+    if (inverse)
+        for (auto& x : im)
+            x = -x;
+    for (size_t i = 1, j = 0; i != n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for (size_t half = 1; half < n; half *= 2) {
+        const double * wr = roots.re.data() + half;
+        const double * wi = roots.im.data() + half;
+        for (size_t start = 0; start != n; start += 2 * half) {
+            double * __restrict ur = re.data() + start;
+            double * __restrict ui = im.data() + start;
+            double * __restrict xr = ur + half;
+            double * __restrict xi = ui + half;
+            for (size_t k = 0; k != half; ++k) {
+                const double vr = xr[k] * wr[k] - xi[k] * wi[k];
+                const double vi = xr[k] * wi[k] + xi[k] * wr[k];
+                xr[k] = ur[k] - vr;
+                xi[k] = ui[k] - vi;
+                ur[k] += vr;
+                ui[k] += vi;
+            }
+        }
+    }
+
+    if (inverse) {
+        for (auto& x : re)
+            x /= n;
+        for (auto& x : im)
+            x = -x / n;
+    }
+}
+
+template <typename T>
+void addProductFft(const T * a, size_t n, const T * b, size_t m, T * out) {
+    const size_t size = n + m - 1;
+    size_t length = 1;
+    while (length < size)
+        length *= 2;
+    // Оба множителя кладём в одно преобразование: a - в действительную часть, b - в мнимую.
+    // Тогда квадрат (a + ib)^2 = a^2 - b^2 + 2iab, и произведение ab - это половина мнимой части.
+    // Погрешность такого квадрата пропорциональна max(|a|, |b|)^2, а не |a| |b|: если множители разного масштаба
+    // (как rev(a) и ряд 1 / rev(b) при делении), больший съедает точность меньшего. Поэтому a умножаем на 2^shift,
+    // а b - на 2^-shift так, чтобы их наибольшие коэффициенты сравнялись. Умножение на степень двойки точное,
+    // а в произведении множители сокращаются.
+    double maxA = 0, maxB = 0;
+    for (size_t i = 0; i != n; ++i)
+        maxA = std::max(maxA, std::abs(double(a[i])));
+    for (size_t i = 0; i != m; ++i)
+        maxB = std::max(maxB, std::abs(double(b[i])));
+    int exponentA = 0, exponentB = 0;
+    std::frexp(maxA, &exponentA);
+    std::frexp(maxB, &exponentB);
+    const int shift = (exponentB - exponentA) / 2;
+    std::vector<double> re(length), im(length);
+    for (size_t i = 0; i != n; ++i)
+        re[i] = std::ldexp(double(a[i]), shift);
+    for (size_t i = 0; i != m; ++i)
+        im[i] = std::ldexp(double(b[i]), -shift);
+    fft(re, im, false);
+    for (size_t i = 0; i != length; ++i) {
+        const double r = re[i] * re[i] - im[i] * im[i];
+        im[i] = 2 * re[i] * im[i];
+        re[i] = r;
+    }
+    fft(re, im, true);
+    for (size_t i = 0; i != size; ++i)
+        out[i] += static_cast<T>(im[i] / 2);
+}
+
+template <typename T>
+Wide maxAbs(const T * a, size_t n) {
+    Wide result = 0;
+    for (size_t i = 0; i != n; ++i)
+        result = std::max(result, a[i] < 0 ? -Wide(a[i]) : Wide(a[i]));
+    return result;
+}
+
+// Можно ли посчитать произведение через NTT без потери точности.
+// Оценка сверху для коэффициента произведения: max|a| * max|b| * min(n, m).
+inline bool fitsExactly(Wide maxA, Wide maxB, size_t n, size_t m) {
+    if (n + m - 1 > MaxTransformLength)
+        return false;
+    const Wide limit = productOfPrimes() / 2;
+    if (maxA == 0 || maxB == 0)
+        return true;
+    return maxA <= limit / maxB && maxA * maxB <= limit / Wide(std::min(n, m));
+}
+
+// Умножение через NTT или FFT, если оно применимо к типу T и не теряет точности.
+// Записывает произведение в out (длины n + m - 1) и возвращает true; иначе возвращает false и out не трогает.
+template <typename T>
+bool multiplyTransform(const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& out) {
+    const size_t n = a.size(), m = b.size();
+    if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+        if (!fitsExactly(maxAbs(a.data(), n), maxAbs(b.data(), m), n, m))
+            return false;
+        auto residue = [](const std::vector<T>& v) {
+            return [&v](size_t i, uint32_t prime) {
+                const long long r = static_cast<long long>(v[i]) % prime;
+                return static_cast<uint32_t>(r < 0 ? r + prime : r);
+            };
+        };
+        const auto exact = convolveExact(n, m, residue(a), residue(b));
+        for (size_t i = 0; i != out.size(); ++i)
+            out[i] = static_cast<T>(exact[i]);
+        return true;
+    } else if constexpr (HasModulus<T>::value) {
+        if (!fitsExactly(T::Modulus - 1, T::Modulus - 1, n, m))
+            return false;
+        if constexpr (T::Modulus == Prime1) {  // модуль сам годится для NTT: хватит одного преобразования
+            std::vector<uint32_t> ra(n), rb(m);
+            for (size_t i = 0; i != n; ++i)
+                ra[i] = a[i].get();
+            for (size_t i = 0; i != m; ++i)
+                rb[i] = b[i].get();
+            const auto c = NumberTheoreticTransform<Prime1>::convolve(std::move(ra), std::move(rb), out.size());
+            for (size_t i = 0; i != out.size(); ++i)
+                out[i] = T(c[i]);
+        } else {
+            auto residue = [](const std::vector<T>& v) {
+                return [&v](size_t i, uint32_t prime) {
+                    return static_cast<uint32_t>(v[i].get() % prime);
+                };
+            };
+            const auto exact = convolveExact(n, m, residue(a), residue(b));
+            for (size_t i = 0; i != out.size(); ++i)
+                out[i] = T(static_cast<long long>(exact[i] % T::Modulus));
+        }
+        return true;
+    } else if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value) {
+        addProductFft(a.data(), n, b.data(), m, out.data());
+        return true;
+    } else {
+        return false;
+    }
+}
+
+// С какой длины выгоднее NTT/FFT, чем Карацуба. Целым нужны три NTT и китайская теорема об остатках,
+// вычетам по модулю Prime1 хватает одного NTT, а у БПФ над double самая дешёвая бабочка.
+template <typename T>
+constexpr size_t transformThreshold() {
+    if constexpr (std::is_floating_point<T>::value)
+        return 768;
+    else if constexpr (std::is_integral<T>::value)
+        return 16384;
+    else if constexpr (HasModulus<T>::value)
+        return T::Modulus == Prime1 ? 512 : 4096;
+    else
+        return std::numeric_limits<size_t>::max();
+}
+
+template <typename T>
+std::vector<T> multiply(const std::vector<T>& a, const std::vector<T>& b) {
+    if (a.empty() || b.empty())
+        return {};
+    const size_t n = a.size(), m = b.size(), shorter = std::min(n, m);
+    std::vector<T> out(n + m - 1, T(0));
+
+    if (shorter < karatsubaThreshold<T>())
+        addProductSchoolbook(a.data(), n, b.data(), m, out.data());
+    else if (shorter < transformThreshold<T>() || !multiplyTransform(a, b, out))
+        addProductUnbalanced(a.data(), n, b.data(), m, out.data());
+    return out;
+}
+
+// Деление с остатком "столбиком" за O((n - m) m): a = q b + r, deg r < deg b.
+// Предполагается, что коэффициенты лежат в поле: для целых чисел частное коэффициентов округляется,
+// а старший член остатка просто отбрасывается. a и b без ведущих нулей, b не пуст, a не короче b.
+template <typename T>
+std::pair<std::vector<T>, std::vector<T>> divideLong(const std::vector<T>& a, const std::vector<T>& b) {
+    const size_t m = b.size();
+    const T lead = b.back();
+    // В поле вычетов деление - это возведение в степень (см. ModInt::inverse), так что делим на lead один раз.
+    // Встроенные типы делим как раньше: у целых 1 / lead обнулится, а у double изменится округление.
+    const T inverseLead = std::is_arithmetic<T>::value ? T(1) : T(1) / lead;
+    std::vector<T> remainder = a;
+    std::vector<T> quotient(a.size() - m + 1);
+    for (size_t k = quotient.size(); k-- > 0; ) {
+        const T c = std::is_arithmetic<T>::value ? remainder[k + m - 1] / lead : remainder[k + m - 1] * inverseLead;
+        quotient[k] = c;
+        if (c != T(0))
+            addScaled(remainder.data() + k, b.data(), -c, m - 1);
+        remainder[k + m - 1] = T(0);
+    }
+    remainder.resize(m - 1);
+    return {std::move(quotient), std::move(remainder)};
+}
+
+// Обратный степенной ряд: g = 1 / f mod x^k, нужен обратимый f[0].
+// Метод Ньютона g <- g (2 - f g) удваивает число верных коэффициентов за шаг,
+// так что всё стоит как несколько умножений длины k.
+template <typename T>
+std::vector<T> inverseSeries(const std::vector<T>& f, size_t k) {
+    std::vector<T> g(1, T(1) / f[0]);
+    for (size_t length = 1; length < k; ) {
+        length = std::min(2 * length, k);
+        std::vector<T> head(f.begin(), f.begin() + std::min(f.size(), length));
+        std::vector<T> error = multiply(head, g);
+        error.resize(length, T(0));
+        for (auto& c : error)
+            c = -c;
+        error[0] += T(2);
+        g = multiply(g, error);
+        g.resize(length, T(0));
+    }
+    return g;
+}
+
+// Деление через обращение ряда. Если развернуть порядок коэффициентов, rev(a) = rev(q) rev(b) + x^(n-m+1) (...),
+// поэтому rev(q) = rev(a) / rev(b) mod x^(n-m+1), а остаток - это a - q b.
+// Старший коэффициент b должен быть обратим в T, поэтому путь годится для полей (вычеты, double), но не для целых:
+// даже при старшем коэффициенте +-1 коэффициенты ряда 1 / rev(b) растут экспоненциально
+// и переполняют T, хотя само частное может быть маленьким.
+template <typename T>
+std::pair<std::vector<T>, std::vector<T>> divideNewton(const std::vector<T>& a, const std::vector<T>& b) {
+    const size_t n = a.size(), m = b.size(), k = n - m + 1;
+    std::vector<T> reversedA(a.rbegin(), a.rbegin() + k);
+    std::vector<T> reversedB(b.rbegin(), b.rbegin() + std::min(m, k));
+    std::vector<T> quotient = multiply(reversedA, inverseSeries(reversedB, k));
+    quotient.resize(k);
+    std::reverse(quotient.begin(), quotient.end());
+
+    std::vector<T> remainder(a.begin(), a.begin() + (m - 1));
+    if (m > 1) {
+        std::vector<T> lowQ(quotient.begin(), quotient.begin() + std::min(k, m - 1));
+        std::vector<T> lowB(b.begin(), b.end() - 1);
+        const std::vector<T> product = multiply(lowQ, lowB);
+        for (size_t i = 0; i != m - 1; ++i)
+            remainder[i] -= product[i];
+    }
+    return {std::move(quotient), std::move(remainder)};
+}
+
+// С какой длины частного и делителя деление через ряды обгоняет "столбик".
+// Ньютон стоит несколько умножений, поэтому выигрывает только там, где умножение уже идёт через NTT/FFT.
+template <typename T>
+constexpr size_t newtonThreshold() {
+    if constexpr (std::is_floating_point<T>::value)
+        return 1024;
+    else if constexpr (HasModulus<T>::value)
+        return T::Modulus == Prime1 ? 2048 : 8192;
+    else
+        return 4096;
+}
+
+// Целые делим только "столбиком": там промежуточные числа - это остатки, ограниченные вместе с ответом,
+// а у divideNewton промежуточный обратный ряд переполняется (см. комментарий к нему).
+template <typename T>
+std::pair<std::vector<T>, std::vector<T>> divide(const std::vector<T>& a, const std::vector<T>& b) {
+    const size_t quotientSize = a.size() - b.size() + 1;
+    if (!std::is_integral<T>::value && std::min(quotientSize, b.size()) >= newtonThreshold<T>())
+        return divideNewton(a, b);
+    return divideLong(a, b);
+}
+
+// Значения многочлена c[0 .. n) в точках x[0 .. count) по схеме Горнера.
+// Одна точка - это цепочка зависимых умножений, поэтому ведём сразу Lanes точек:
+// цепочки независимы, и для встроенных типов GCC превращает внутренний цикл в векторные инструкции.
+template <typename T>
+void evaluateHorner(const T * c, size_t n, const T * __restrict x, T * __restrict out, size_t count) {
+    const size_t Lanes = 16;
+    size_t i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        T point[Lanes], value[Lanes];
+        for (size_t t = 0; t != Lanes; ++t) {
+            point[t] = x[i + t];
+            value[t] = T(0);
+        }
+        for (size_t k = n; k-- > 0; )
+            for (size_t t = 0; t != Lanes; ++t)
+                value[t] = value[t] * point[t] + c[k];
+        for (size_t t = 0; t != Lanes; ++t)
+            out[i + t] = value[t];
+    }
+    for (; i != count; ++i) {
+        T value = T(0);
+        for (size_t k = n; k-- > 0; )
+            value = value * x[i] + c[k];
+        out[i] = value;
+    }
+}
+
+// Дерево подпроизведений: в вершине лежит произведение (x - x_i) по её отрезку точек.
+// p(x_i) - это остаток от деления p на (x - x_i), а остаток по модулю вершины можно брать от остатка
+// по модулю родителя. Спускаясь по дереву, делим многочлены всё меньшей степени: O(M(n) log n) вместо O(n^2).
+// Листья дерева - блоки по LeafSize точек, в них остаток уже короткий и дешевле досчитать схемой Горнера.
+template <typename T>
+class SubproductTree {
+private:
+    static const size_t LeafSize = 64;
+
+    const T * points;
+    size_t count;
+    std::vector<std::vector<T>> products;  // вершина v, дети 2v + 1 и 2v + 2
+
+    void build(size_t v, size_t begin, size_t end) {
+        if (end - begin <= LeafSize) {
+            std::vector<T>& product = products[v];
+            product.assign(1, T(1));
+            for (size_t i = begin; i != end; ++i) {
+                product.push_back(T(0));
+                for (size_t k = product.size() - 1; k != 0; --k)
+                    product[k] = product[k - 1] - points[i] * product[k];
+                product[0] = -points[i] * product[0];
+            }
+            return;
+        }
+        const size_t middle = begin + (end - begin) / 2;
+        build(2 * v + 1, begin, middle);
+        build(2 * v + 2, middle, end);
+        products[v] = multiply(products[2 * v + 1], products[2 * v + 2]);
+    }
+
+    void descend(size_t v, size_t begin, size_t end, std::vector<T> remainder, T * out) const {
+        if (remainder.size() >= products[v].size())
+            remainder = divide(remainder, products[v]).second;
+        if (end - begin <= LeafSize) {
+            evaluateHorner(remainder.data(), remainder.size(), points + begin, out + begin, end - begin);
+            return;
+        }
+        const size_t middle = begin + (end - begin) / 2;
+        descend(2 * v + 1, begin, middle, remainder, out);
+        descend(2 * v + 2, middle, end, std::move(remainder), out);
+    }
+
+public:
+    SubproductTree(const T * x, size_t n): points(x), count(n), products(4 * (n / LeafSize + 1)) {
+        build(0, 0, count);
+    }
+
+    void evaluate(const std::vector<T>& p, T * out) const {
+        descend(0, 0, count, p, out);
+    }
+};
+
+// Дерево выгодно, только когда и степень, и число точек большие; точки берём блоками порядка степени,
+// иначе дерево по миллиону точек стоило бы больше, чем Горнер для короткого многочлена.
+// Деление требует точной арифметики в поле, поэтому дерево используется только для вычетов.
+// Пороги - по poly_bench evaluate: с одним NTT на умножение дерево обгоняет Горнера раньше.
+template <typename T>
+constexpr size_t multipointThreshold() {
+    return T::Modulus == Prime1 ? 4096 : 8192;
+}
+
+template <typename T>
+std::vector<T> evaluate(const std::vector<T>& p, const std::vector<T>& x) {
+    std::vector<T> out(x.size());
+    if constexpr (HasModulus<T>::value) {
+        if (p.size() >= multipointThreshold<T>() && x.size() >= multipointThreshold<T>()) {
+            for (size_t start = 0; start < x.size(); start += p.size()) {
+                const size_t block = std::min(p.size(), x.size() - start);
+                SubproductTree<T>(x.data() + start, block).evaluate(p, out.data() + start);
+            }
+            return out;
+        }
+    }
+    evaluateHorner(p.data(), p.size(), x.data(), out.data(), x.size());
+    return out;
+}
+
+}  // namespace polynomial_kernels
+
+template <typename T>
+class Polynomial;
+
+namespace polynomial_kernels {
+
+template <typename T>
+Polynomial<T> gcdEuclid(Polynomial<T> a, Polynomial<T> b);
+
+template <typename T>
+Polynomial<T> gcdHalf(Polynomial<T> a, Polynomial<T> b);
+
+}  // namespace polynomial_kernels
+
+template <typename T>
+class Polynomial {
+private:
+    std::vector<T> coefficients;
+
+    void normalize() {
+        while (!coefficients.empty() && coefficients.back() == T(0))
+            coefficients.pop_back();
+    }
+
+    static std::pair<Polynomial, Polynomial> divide(const Polynomial& a, const Polynomial& b) {
+        if (b.coefficients.empty())
+            throw ZeroDivisionException();
+        if (a.Degree() < b.Degree())
+            return {Polynomial(), a};
+        auto result = polynomial_kernels::divide(a.coefficients, b.coefficients);
+        return {Polynomial(std::move(result.first)), Polynomial(std::move(result.second))};
+    }
+
+public:
+    Polynomial(const std::vector<T>& c): coefficients(c) {
+        normalize();
+    }
+
+    Polynomial(std::vector<T>&& c): coefficients(std::move(c)) {
+        normalize();
+    }
+
+    Polynomial(const T& c = T()): coefficients(1, c) {
+        normalize();
+    }
+
+    template <typename Iter>
+    Polynomial(Iter first, Iter last): coefficients(first, last) {
+        normalize();
+    }
+
+    int Degree() const {
+        return static_cast<int>(coefficients.size()) - 1;
+    }
+
+    T operator [] (size_t i) const {
+        return i < coefficients.size() ? coefficients[i] : T(0);
+    }
+
+    typename std::vector<T>::const_iterator begin() const {
+        return coefficients.begin();
+    }
+
+    typename std::vector<T>::const_iterator end() const {
+        return coefficients.end();
+    }
+
+    // Значение в точке по схеме Горнера
+    T operator () (const T& x) const {
+        T result = T(0);
+        for (auto it = coefficients.rbegin(); it != coefficients.rend(); ++it)
+            result = result * x + *it;
+        return result;
+    }
+
+    // Значения сразу во многих точках (см. polynomial_kernels::evaluate)
+    std::vector<T> operator () (const std::vector<T>& points) const {
+        return polynomial_kernels::evaluate(coefficients, points);
+    }
+
+    friend bool operator == (const Polynomial& a, const Polynomial& b) {
+        return a.coefficients == b.coefficients;
+    }
+
+    friend bool operator != (const Polynomial& a, const Polynomial& b) {
+        return !(a == b);
+    }
+
+    Polynomial& operator += (const Polynomial& other) {
+        if (coefficients.size() < other.coefficients.size())
+            coefficients.resize(other.coefficients.size(), T(0));
+        for (size_t i = 0; i != other.coefficients.size(); ++i)
+            coefficients[i] += other.coefficients[i];
+        normalize();
+        return *this;
+    }
+
+    Polynomial& operator -= (const Polynomial& other) {
+        if (coefficients.size() < other.coefficients.size())
+            coefficients.resize(other.coefficients.size(), T(0));
+        for (size_t i = 0; i != other.coefficients.size(); ++i)
+            coefficients[i] -= other.coefficients[i];
+        normalize();
+        return *this;
+    }
+
+    Polynomial& operator *= (const Polynomial& other) {
+        coefficients = polynomial_kernels::multiply(coefficients, other.coefficients);
+        normalize();
+        return *this;
+    }
+
+    Polynomial& operator *= (const T& scalar) {
+        for (auto& c : coefficients)
+            c *= scalar;
+        normalize();
+        return *this;
+    }
+
+    friend Polynomial operator + (Polynomial a, const Polynomial& b) {
+        return a += b;
+    }
+
+    friend Polynomial operator - (Polynomial a, const Polynomial& b) {
+        return a -= b;
+    }
+
+    friend Polynomial operator * (const Polynomial& a, const Polynomial& b) {
+        return Polynomial(polynomial_kernels::multiply(a.coefficients, b.coefficients));
+    }
+
+    friend Polynomial operator / (const Polynomial& a, const Polynomial& b) {
+        return divide(a, b).first;
+    }
+
+    friend Polynomial operator % (const Polynomial& a, const Polynomial& b) {
+        return divide(a, b).second;
+    }
+
+    // Наибольший общий делитель: алгоритм Евклида, для больших степеней над полем - half-gcd.
+    // Над полем нормируем его так, чтобы старший коэффициент был равен 1,
+    // для целых коэффициентов - только делаем старший коэффициент положительным.
+    friend Polynomial operator , (Polynomial a, Polynomial b) {
+        if constexpr (std::is_arithmetic<T>::value)
+            a = polynomial_kernels::gcdEuclid(std::move(a), std::move(b));
+        else
+            a = polynomial_kernels::gcdHalf(std::move(a), std::move(b));
+        if (!a.coefficients.empty()) {
+            if constexpr (std::is_integral<T>::value) {
+                if (a.coefficients.back() < T(0))
+                    a *= T(-1);
+            } else {
+                const T lead = a.coefficients.back();
+                for (auto& c : a.coefficients)
+                    c /= lead;
+            }
+        }
+        return a;
+    }
+};
+
+namespace polynomial_kernels {
+
+template <typename T>
+Polynomial<T> gcdEuclid(Polynomial<T> a, Polynomial<T> b) {
+    while (b.Degree() >= 0) {
+        a = a % b;
+        std::swap(a, b);
+    }
+    return a;
+}
+
+// Матрица 2x2 из многочленов, которая переводит пару (a, b) в пару (a', b') той же последовательности Евклида
+template <typename T>
+struct Transition {
+    Polynomial<T> m00 = T(1), m01, m10, m11 = T(1);
+
+    std::pair<Polynomial<T>, Polynomial<T>> apply(const Polynomial<T>& a, const Polynomial<T>& b) const {
+        return {m00 * a + m01 * b, m10 * a + m11 * b};
+    }
+
+    // Сначала y, потом x
+    friend Transition operator * (const Transition& x, const Transition& y) {
+        return {x.m00 * y.m00 + x.m01 * y.m10, x.m00 * y.m01 + x.m01 * y.m11,
+                x.m10 * y.m00 + x.m11 * y.m10, x.m10 * y.m01 + x.m11 * y.m11};
+    }
+};
+
+// p div x^k: отбрасываем k младших коэффициентов
+template <typename T>
+Polynomial<T> dropLow(const Polynomial<T>& p, int k) {
+    if (p.Degree() < k)
+        return Polynomial<T>();
+    return Polynomial<T>(p.begin() + k, p.end());
+}
+
+// Half-gcd: для deg a > deg b находит матрицу, которая проходит шаги Евклида, пока степень b
+// не станет меньше ceil(deg a / 2). Частные в начале последовательности Евклида зависят только
+// от старших коэффициентов, поэтому первую половину шагов можно найти рекурсивно по старшим половинам a и b.
+// Вместе с быстрым умножением и делением это O(M(n) log n) вместо O(n^2).
+// Ниже этой степени рекурсия half-gcd дороже, чем шаги Евклида с накоплением матрицы
+const int HalfGcdBase = 128;
+// Ниже этой степени весь НОД быстрее считать алгоритмом Евклида: у half-gcd большая константа,
+// а шаг Евклида - это деление столбиком, которое для вычетов векторизуется. Без NTT по Prime1
+// умножения в half-gcd идут через три NTT, и он окупается ещё позже.
+template <typename T>
+constexpr int halfGcdThreshold() {
+    if constexpr (HasModulus<T>::value)
+        return T::Modulus == Prime1 ? 8192 : 32768;
+    else
+        return 4096;
+}
+
+// Частное и остаток за одно деление (операторы / и % делят каждый заново)
+template <typename T>
+std::pair<Polynomial<T>, Polynomial<T>> divideWithRemainder(const Polynomial<T>& a, const Polynomial<T>& b) {
+    if (a.Degree() < b.Degree())
+        return {Polynomial<T>(), a};
+    auto result = divide(std::vector<T>(a.begin(), a.end()), std::vector<T>(b.begin(), b.end()));
+    return {Polynomial<T>(std::move(result.first)), Polynomial<T>(std::move(result.second))};
+}
+
+// Один шаг Евклида (a, b) -> (b, a - q b) в виде матрицы: [[0, 1], [1, -q]] * t
+template <typename T>
+Transition<T> euclidStep(const Transition<T>& t, const Polynomial<T>& q) {
+    return {t.m10, t.m11, t.m00 - q * t.m10, t.m01 - q * t.m11};
+}
+
+template <typename T>
+Transition<T> halfGcd(const Polynomial<T>& a, const Polynomial<T>& b) {
+    const int m = (a.Degree() + 1) / 2;
+    if (b.Degree() < m)
+        return Transition<T>();
+    if (a.Degree() < HalfGcdBase) {
+        Transition<T> result;
+        Polynomial<T> x = a, y = b;
+        while (y.Degree() >= m) {
+            auto [q, r] = divideWithRemainder(x, y);
+            result = euclidStep(result, q);
+            x = std::move(y);
+            y = std::move(r);
+        }
+        return result;
+    }
+    const Transition<T> first = halfGcd(dropLow(a, m), dropLow(b, m));
+    auto [x, y] = first.apply(a, b);
+    if (y.Degree() < m)
+        return first;
+
+    const auto [q, r] = divideWithRemainder(x, y);
+    const int k = 2 * m - y.Degree();
+    return halfGcd(dropLow(y, k), dropLow(r, k)) * euclidStep(first, q);
+}
+
+template <typename T>
+Polynomial<T> gcdHalf(Polynomial<T> a, Polynomial<T> b) {
+    if (a.Degree() < b.Degree())
+        std::swap(a, b);
+    while (b.Degree() >= 0) {
+        if (b.Degree() < halfGcdThreshold<T>())
+            return gcdEuclid(std::move(a), std::move(b));
+        if (a.Degree() == b.Degree()) {
+            a = a % b;
+            std::swap(a, b);
+            continue;
+        }
+        auto [x, y] = halfGcd(a, b).apply(a, b);
+        if (y.Degree() < 0)
+            return x;
+        b = x % y;
+        a = std::move(y);
+    }
+    return a;
+}
+
+}  // namespace polynomial_kernels
+
+// Коэффициент члена со знаком; first - это старший член, перед ним не нужен '+'.
+// У члена без переменных (constant) единица не опускается. Возвращает true, если коэффициент напечатан
+// и перед переменными нужен знак умножения.
+template <typename T>
+bool printCoefficient(std::ostream& out, T c, bool first, bool constant) {
+    bool negative = false;
+    if constexpr (std::is_arithmetic<T>::value) {
+        negative = c < T(0);
+        if (negative)
+            c = -c;
+    }
+    if (negative)
+        out << '-';
+    else if (!first)
+        out << '+';
+    if (constant || c != T(1)) {
+        out << c;
+        return !constant;
+    }
+    return false;
+}
+
+// Один член c*x^i в записи многочлена
+template <typename T>
+void printTerm(std::ostream& out, const T& c, size_t i, bool first) {
+    if (printCoefficient(out, c, first, i == 0))
+        out << '*';
+    if (i > 0)
+        out << 'x';
+    if (i > 1)
+        out << '^' << i;
+}
+
+// Печатаем от старшей степени к младшей: 3*x^2-x+1
+template <typename T>
+std::ostream& operator << (std::ostream& out, const Polynomial<T>& p) {
+    if (p.Degree() < 0)
+        return out << T(0);
+    for (int i = p.Degree(); i >= 0; --i)
+        if (p[i] != T(0))
+            printTerm(out, p[i], i, i == p.Degree());
+    return out;
+}
+
+namespace polynomial_kernels {
+
+// Разреженные многочлены - это упорядоченные по ключу списки пар (ключ одночлена, коэффициент) без нулевых коэффициентов.
+// Ключ - степень у SparsePolynomial и упакованный вектор степеней у MultivariatePolynomial.
+
+// Слияние двух списков: a + sign * b
+template <typename Key, typename T>
+std::vector<std::pair<Key, T>> mergeTerms(const std::vector<std::pair<Key, T>>& a,
+                                          const std::vector<std::pair<Key, T>>& b, const T& sign) {
+    std::vector<std::pair<Key, T>> out;
+    out.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    while (i != a.size() || j != b.size()) {
+        if (j == b.size() || (i != a.size() && a[i].first < b[j].first)) {
+            out.push_back(a[i++]);
+        } else if (i == a.size() || b[j].first < a[i].first) {
+            out.emplace_back(b[j].first, sign * b[j].second);
+            ++j;
+        } else {
+            const T c = a[i].second + sign * b[j].second;
+            if (c != T(0))
+                out.emplace_back(a[i].first, c);
+            ++i;
+            ++j;
+        }
+    }
+    return out;
+}
+
+// Умножение через кучу (алгоритм Джонсона): для каждого члена x_i короче из множителей в куче лежит
+// следующее произведение x_i * y_j. Кандидаты выходят по возрастанию ключа, так что одинаковые одночлены
+// складываются сразу и результат получается упорядоченным: O(n m log min(n, m)) по числу членов.
+// combine(k1, k2) - ключ произведения одночленов; он должен возрастать по каждому аргументу.
+template <typename Key, typename T, typename Combine>
+std::vector<std::pair<Key, T>> multiplyTerms(const std::vector<std::pair<Key, T>>& a,
+                                             const std::vector<std::pair<Key, T>>& b, Combine combine) {
+    const auto& x = a.size() <= b.size() ? a : b;
+    const auto& y = a.size() <= b.size() ? b : a;
+    std::vector<std::pair<Key, T>> result;
+    if (x.empty())
+        return result;
+
+    typedef std::pair<Key, size_t> Candidate;  // (ключ произведения, i); j хранится в next[i]
+    std::vector<size_t> next(x.size(), 0);
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+    for (size_t i = 0; i != x.size(); ++i)
+        heap.emplace(combine(x[i].first, y[0].first), i);
+    while (!heap.empty()) {
+        const auto [key, i] = heap.top();
+        heap.pop();
+        const T c = x[i].second * y[next[i]].second;
+        if (!result.empty() && result.back().first == key) {
+            result.back().second += c;
+        } else {
+            if (!result.empty() && result.back().second == T(0))
+                result.pop_back();
+            result.emplace_back(key, c);
+        }
+        if (++next[i] != y.size())
+            heap.emplace(combine(x[i].first, y[next[i]].first), i);
+    }
+    if (result.back().second == T(0))
+        result.pop_back();
+    return result;
+}
+
+// Сумма членов с одинаковыми ключами: хеш-таблица с открытой адресацией и линейным пробированием.
+// Ключи и коэффициенты лежат в двух плоских массивах, узлов в куче нет. Ключ, у которого все биты единичные,
+// служит меткой пустой ячейки: у упакованного одночлена такого не бывает, сторожевые биты у него нулевые.
+template <typename Key, typename T>
+class TermAccumulator {
+private:
+    static constexpr Key Empty = std::numeric_limits<Key>::max();
+
+    unsigned bits = 4;
+    size_t used = 0;
+    std::vector<Key> keys;
+    std::vector<T> values;
+
+    size_t slot(Key key) const {
+        const size_t mask = keys.size() - 1;
+        size_t h = static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+        while (keys[h] != key && keys[h] != Empty)
+            h = (h + 1) & mask;
+        return h;
+    }
+
+    // Заполняем не больше половины ячеек, иначе цепочки пробирования становятся длинными
+    void grow() {
+        std::vector<Key> oldKeys(size_t(1) << ++bits, Empty);
+        std::vector<T> oldValues(oldKeys.size(), T(0));
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        for (size_t i = 0; i != oldKeys.size(); ++i)
+            if (oldKeys[i] != Empty) {
+                const size_t h = slot(oldKeys[i]);
+                keys[h] = oldKeys[i];
+                values[h] = oldValues[i];
+            }
+    }
+
+public:
+    explicit TermAccumulator(size_t expected = 0) {
+        while ((size_t(1) << bits) < 2 * expected)
+            ++bits;
+        keys.assign(size_t(1) << bits, Empty);
+        values.assign(keys.size(), T(0));
+    }
+
+    void add(Key key, const T& value) {
+        size_t h = slot(key);
+        if (keys[h] == Empty) {
+            if (2 * (used + 1) > keys.size()) {
+                grow();
+                h = slot(key);
+            }
+            keys[h] = key;
+            ++used;
+        }
+        values[h] += value;
+    }
+
+    // Пустая таблица того же размера: поток переиспользует её для следующего блока
+    void clear() {
+        std::fill(keys.begin(), keys.end(), Empty);
+        std::fill(values.begin(), values.end(), T(0));
+        used = 0;
+    }
+
+    // Ненулевые суммы по возрастанию ключа
+    std::vector<std::pair<Key, T>> sorted() const {
+        std::vector<std::pair<Key, T>> result;
+        result.reserve(used);
+        for (size_t i = 0; i != keys.size(); ++i)
+            if (keys[i] != Empty && values[i] != T(0))
+                result.emplace_back(keys[i], values[i]);
+        std::sort(result.begin(), result.end(), [](const std::pair<Key, T>& a, const std::pair<Key, T>& b) {
+            return a.first < b.first;
+        });
+        return result;
+    }
+};
+
+// Умножение с накоплением в хеш-таблице. Когда произведений одного одночлена много (плотные многочлены
+// от нескольких переменных: у произведения в разы меньше членов, чем пар), это в десятки раз быстрее кучи:
+// на пару приходится одно сложение ключей и одна ячейка таблицы вместо log n сравнений.
+template <typename Key, typename T, typename Combine>
+std::vector<std::pair<Key, T>> multiplyTermsHashed(const std::vector<std::pair<Key, T>>& a,
+                                                   const std::vector<std::pair<Key, T>>& b, Combine combine) {
+    TermAccumulator<Key, T> sum(a.size() + b.size());
+    for (const auto& x : a)
+        for (const auto& y : b)
+            sum.add(combine(x.first, y.first), x.second * y.second);
+    return sum.sorted();
+}
+
+inline size_t defaultThreads() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Задания 0, ..., count - 1 раздаются потокам по одному через общий счётчик; job(i, worker) получает
+// и номер потока, чтобы пользоваться его собственными данными. Исключение из задания пробрасывается наружу.
+template <typename Job>
+void runParallel(size_t count, size_t threads, Job job) {
+    threads = std::max<size_t>(1, std::min(threads, count));
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(threads);
+    auto work = [&](size_t worker) {
+        try {
+            for (size_t i = next++; i < count; i = next++)
+                job(i, worker);
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t k = 1; k < threads; ++k)
+        workers.emplace_back(work, k);
+    work(0);
+    for (auto& w : workers)
+        w.join();
+    for (auto& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+
+// Меньше пар члены умножаем в одном потоке: запуск потоков дороже
+const size_t MinParallelPairs = 1 << 18;
+// На столько диапазонов режем ключи произведения: с запасом больше потоков, чтобы их было чем загрузить
+const size_t ParallelRanges = 64;
+
+// Многопоточное умножение. Пары членов делятся между потоками по ключу их произведения:
+// задание r отвечает за одночлены из диапазона [bounds[r - 1], bounds[r]) и накапливает их в хеш-таблице
+// своего потока (таблица одна на поток, между заданиями только очищается). При фиксированном x_i
+// ключ combine(x_i, y_j) растёт с j, поэтому пары с ключом из диапазона - это отрезок по j, и он находится
+// двоичным поиском. Диапазоны не пересекаются и идут по возрастанию, так что отсортированные куски
+// просто приписываются друг к другу. Каждый коэффициент складывается в том же порядке (по i, затем по j),
+// что и в multiplyTermsHashed, поэтому ответ не зависит от числа потоков даже для double.
+// Границы диапазонов - квантили ключей у равномерной выборки пар, тогда и пар в диапазонах примерно поровну.
+template <typename Key, typename T, typename Combine>
+std::vector<std::pair<Key, T>> multiplyTermsParallel(const std::vector<std::pair<Key, T>>& a,
+                                                     const std::vector<std::pair<Key, T>>& b,
+                                                     Combine combine, size_t threads) {
+    typedef std::pair<Key, T> Term;
+    if (double(a.size()) * b.size() < MinParallelPairs)
+        return multiplyTermsHashed(a, b, combine);
+
+    const size_t ranges = ParallelRanges;
+    std::vector<Key> sample;
+    for (size_t i = 0; i != ranges; ++i)
+        for (size_t j = 0; j != ranges; ++j)
+            sample.push_back(combine(a[a.size() * i / ranges].first, b[b.size() * j / ranges].first));
+    std::sort(sample.begin(), sample.end());
+    std::vector<Key> bounds;
+    for (size_t r = 1; r != ranges; ++r)
+        bounds.push_back(sample[sample.size() * r / ranges]);
+
+    std::vector<std::vector<Term>> pieces(ranges);
+    std::vector<TermAccumulator<Key, T>> tables(std::max<size_t>(1, std::min(threads, ranges)));
+    runParallel(ranges, threads, [&](size_t r, size_t worker) {
+        TermAccumulator<Key, T>& sum = tables[worker];
+        for (const auto& x : a) {
+            auto below = [&](const Key& bound) {
+                return [&](const Term& y) {
+                    return combine(x.first, y.first) < bound;
+                };
+            };
+            auto first = r == 0 ? b.begin() : std::partition_point(b.begin(), b.end(), below(bounds[r - 1]));
+            auto last = r + 1 == ranges ? b.end() : std::partition_point(first, b.end(), below(bounds[r]));
+            for (; first != last; ++first)
+                sum.add(combine(x.first, first->first), x.second * first->second);
+        }
+        pieces[r] = sum.sorted();
+        sum.clear();
+    });
+
+    std::vector<Term> result;
+    size_t size = 0;
+    for (const auto& piece : pieces)
+        size += piece.size();
+    result.reserve(size);
+    for (const auto& piece : pieces)
+        result.insert(result.end(), piece.begin(), piece.end());
+    return result;
+}
+
+}  // namespace polynomial_kernels
+
+// Разреженный многочлен (задача A2): хранятся только ненулевые члены, пары (степень, коэффициент)
+// по возрастанию степени. x^1000000 + 1 занимает два элемента, а не миллион.
+template <typename T>
+class SparsePolynomial {
+public:
+    typedef std::pair<size_t, T> Term;
+
+private:
+    std::vector<Term> terms;
+
+    // Деление столбиком с теми же соглашениями, что и у Polynomial: частное коэффициентов,
+    // а старший член остатка на каждом шаге отбрасывается. Шаги идут только по ненулевым членам.
+    static std::pair<SparsePolynomial, SparsePolynomial> divide(const SparsePolynomial& a, const SparsePolynomial& b) {
+        if (b.terms.empty())
+            throw ZeroDivisionException();
+        const size_t degree = b.terms.back().first;
+        const T lead = b.terms.back().second;
+        std::vector<Term> quotient, remainder = a.terms;
+        while (!remainder.empty() && remainder.back().first >= degree) {
+            const Term top = remainder.back();
+            const Term step(top.first - degree, top.second / lead);
+            std::vector<Term> product;
+            if (step.second != T(0)) {
+                quotient.push_back(step);
+                product.reserve(b.terms.size());
+                for (const auto& t : b.terms)
+                    if (step.second * t.second != T(0))
+                        product.emplace_back(t.first + step.first, step.second * t.second);
+            }
+            remainder = polynomial_kernels::mergeTerms(remainder, product, T(-1));
+            if (!remainder.empty() && remainder.back().first == top.first)
+                remainder.pop_back();
+        }
+        std::reverse(quotient.begin(), quotient.end());
+        SparsePolynomial q, r;
+        q.terms = std::move(quotient);
+        r.terms = std::move(remainder);
+        return {q, r};
+    }
+
+    static T power(T x, size_t n) {
+        T result = T(1);
+        for (; n != 0; n /= 2) {
+            if (n % 2 != 0)
+                result *= x;
+            x *= x;
+        }
+        return result;
+    }
+
+public:
+    // Из плотного вектора коэффициентов, начиная с младшей степени (как у Polynomial)
+    SparsePolynomial(const std::vector<T>& c) {
+        for (size_t i = 0; i != c.size(); ++i)
+            if (c[i] != T(0))
+                terms.emplace_back(i, c[i]);
+    }
+
+    // Из списка членов в любом порядке; члены с одинаковой степенью складываются
+    SparsePolynomial(std::vector<Term> t) {
+        std::sort(t.begin(), t.end(), [](const Term& a, const Term& b) {
+            return a.first < b.first;
+        });
+        for (const auto& term : t) {
+            if (!terms.empty() && terms.back().first == term.first)
+                terms.back().second += term.second;
+            else
+                terms.push_back(term);
+            if (terms.back().second == T(0))
+                terms.pop_back();
+        }
+    }
+
+    SparsePolynomial(const T& c = T()) {
+        if (c != T(0))
+            terms.emplace_back(0, c);
+    }
+
+    int Degree() const {
+        return terms.empty() ? -1 : static_cast<int>(terms.back().first);
+    }
+
+    // Коэффициент при x^i - двоичным поиском по степеням
+    T operator [] (size_t i) const {
+        auto it = std::lower_bound(terms.begin(), terms.end(), i, [](const Term& t, size_t e) {
+            return t.first < e;
+        });
+        return it != terms.end() && it->first == i ? it->second : T(0);
+    }
+
+    typename std::vector<Term>::const_iterator begin() const {
+        return terms.begin();
+    }
+
+    typename std::vector<Term>::const_iterator end() const {
+        return terms.end();
+    }
+
+    // Горнер по ненулевым членам: между соседними членами домножаем на x^(разность степеней)
+    T operator () (const T& x) const {
+        if (terms.empty())
+            return T(0);
+        T result = terms.back().second;
+        for (size_t i = terms.size() - 1; i-- > 0; )
+            result = result * power(x, terms[i + 1].first - terms[i].first) + terms[i].second;
+        return result * power(x, terms.front().first);
+    }
+
+    friend bool operator == (const SparsePolynomial& a, const SparsePolynomial& b) {
+        return a.terms == b.terms;
+    }
+
+    friend bool operator != (const SparsePolynomial& a, const SparsePolynomial& b) {
+        return !(a == b);
+    }
+
+    SparsePolynomial& operator += (const SparsePolynomial& other) {
+        terms = polynomial_kernels::mergeTerms(terms, other.terms, T(1));
+        return *this;
+    }
+
+    SparsePolynomial& operator -= (const SparsePolynomial& other) {
+        terms = polynomial_kernels::mergeTerms(terms, other.terms, T(-1));
+        return *this;
+    }
+
+    // Произведение через кучу, см. polynomial_kernels::multiplyTerms
+    friend SparsePolynomial operator * (const SparsePolynomial& a, const SparsePolynomial& b) {
+        SparsePolynomial result;
+        result.terms = polynomial_kernels::multiplyTerms(a.terms, b.terms, [](size_t i, size_t j) {
+            return i + j;
+        });
+        return result;
+    }
+
+    SparsePolynomial& operator *= (const SparsePolynomial& other) {
+        return *this = *this * other;
+    }
+
+    SparsePolynomial& operator *= (const T& scalar) {
+        std::vector<Term> scaled;
+        scaled.reserve(terms.size());
+        for (const auto& t : terms)
+            if (t.second * scalar != T(0))
+                scaled.emplace_back(t.first, t.second * scalar);
+        terms = std::move(scaled);
+        return *this;
+    }
+
+    friend SparsePolynomial operator + (SparsePolynomial a, const SparsePolynomial& b) {
+        return a += b;
+    }
+
+    friend SparsePolynomial operator - (SparsePolynomial a, const SparsePolynomial& b) {
+        return a -= b;
+    }
+
+    friend SparsePolynomial operator / (const SparsePolynomial& a, const SparsePolynomial& b) {
+        return divide(a, b).first;
+    }
+
+    friend SparsePolynomial operator % (const SparsePolynomial& a, const SparsePolynomial& b) {
+        return divide(a, b).second;
+    }
+
+    // НОД алгоритмом Евклида с той же нормировкой, что и у Polynomial
+    friend SparsePolynomial operator , (SparsePolynomial a, SparsePolynomial b) {
+        while (!b.terms.empty()) {
+            a = a % b;
+            std::swap(a, b);
+        }
+        if (!a.terms.empty()) {
+            if constexpr (std::is_integral<T>::value) {
+                if (a.terms.back().second < T(0))
+                    a *= T(-1);
+            } else {
+                const T lead = a.terms.back().second;
+                for (auto& t : a.terms)
+                    t.second /= lead;
+            }
+        }
+        return a;
+    }
+};
+
+template <typename T>
+std::ostream& operator << (std::ostream& out, const SparsePolynomial<T>& p) {
+    if (p.Degree() < 0)
+        return out << T(0);
+    for (auto it = p.end(); it != p.begin(); ) {
+        --it;
+        printTerm(out, it->second, it->first, it + 1 == p.end());
+    }
+    return out;
+}
+
+// Вектор степеней (e_1, ..., e_N) в одном 64-битном слове: по Bits бит на переменную, e_1 - в старших битах.
+// Тогда порядок чисел совпадает с лексикографическим порядком векторов, то есть с порядком ключей std::map.
+// Старший бит каждого поля - сторожевой: у допустимого одночлена он нулевой, поэтому при сложении ключей
+// (умножении одночленов) перенос не уходит в соседнее поле, а переполнение видно по сторожевым битам суммы.
+template <size_t N>
+struct MonomialPacking {
+    static_assert(N >= 1 && N <= 32, "MonomialPacking: от 1 до 32 переменных");
+
+    static const unsigned Bits = 64 / N < 32 ? 64 / N : 32;
+    static const uint64_t MaxExponent = (uint64_t(1) << (Bits - 1)) - 1;
+
+    static constexpr unsigned shift(size_t i) {
+        return (N - 1 - i) * Bits;
+    }
+
+    static constexpr uint64_t guardMask() {
+        uint64_t mask = 0;
+        for (size_t i = 0; i != N; ++i)
+            mask |= (MaxExponent + 1) << shift(i);
+        return mask;
+    }
+
+    static uint64_t pack(const std::array<int, N>& e) {
+        uint64_t key = 0;
+        for (size_t i = 0; i != N; ++i) {
+            if (e[i] < 0 || static_cast<uint64_t>(e[i]) > MaxExponent)
+                throw MonomialOverflowException();
+            key |= static_cast<uint64_t>(e[i]) << shift(i);
+        }
+        return key;
+    }
+
+    static int exponent(uint64_t key, size_t i) {
+        return static_cast<int>((key >> shift(i)) & (2 * MaxExponent + 1));
+    }
+
+    static uint64_t multiply(uint64_t a, uint64_t b) {
+        const uint64_t key = a + b;
+        if ((key & guardMask()) != 0)
+            throw MonomialOverflowException();
+        return key;
+    }
+};
+
+// Многочлен от N переменных (задача A3). Члены - пары (упакованный одночлен, коэффициент) по возрастанию ключа,
+// как у SparsePolynomial; сложение - слияние списков, умножение - с накоплением в хеш-таблице.
+template <typename T, size_t N>
+class MultivariatePolynomial {
+public:
+    typedef std::array<int, N> Monomial;
+    typedef MonomialPacking<N> Packing;
+    typedef std::pair<uint64_t, T> Term;
+
+private:
+    std::vector<Term> terms;
+
+    static T power(T x, int n) {
+        T result = T(1);
+        for (; n != 0; n /= 2) {
+            if (n % 2 != 0)
+                result *= x;
+            x *= x;
+        }
+        return result;
+    }
+
+public:
+    MultivariatePolynomial(const std::map<Monomial, T>& c) {
+        terms.reserve(c.size());
+        for (const auto& [monomial, coefficient] : c)  // std::map уже упорядочен так же, как ключи
+            if (coefficient != T(0))
+                terms.emplace_back(Packing::pack(monomial), coefficient);
+    }
+
+    MultivariatePolynomial(const T& c = T()) {
+        if (c != T(0))
+            terms.emplace_back(0, c);
+    }
+
+    // Полная степень: наибольшая сумма степеней по членам, у нуля -1
+    int Degree() const {
+        int degree = -1;
+        for (const auto& t : terms) {
+            int sum = 0;
+            for (size_t i = 0; i != N; ++i)
+                sum += Packing::exponent(t.first, i);
+            degree = std::max(degree, sum);
+        }
+        return degree;
+    }
+
+    typename std::vector<Term>::const_iterator begin() const {
+        return terms.begin();
+    }
+
+    typename std::vector<Term>::const_iterator end() const {
+        return terms.end();
+    }
+
+    T operator () (const std::array<int, N>& x) const {
+        T result = T(0);
+        for (const auto& t : terms) {
+            T value = t.second;
+            for (size_t i = 0; i != N; ++i)
+                value *= power(T(x[i]), Packing::exponent(t.first, i));
+            result += value;
+        }
+        return result;
+    }
+
+    friend bool operator == (const MultivariatePolynomial& a, const MultivariatePolynomial& b) {
+        return a.terms == b.terms;
+    }
+
+    friend bool operator != (const MultivariatePolynomial& a, const MultivariatePolynomial& b) {
+        return !(a == b);
+    }
+
+    MultivariatePolynomial& operator += (const MultivariatePolynomial& other) {
+        terms = polynomial_kernels::mergeTerms(terms, other.terms, T(1));
+        return *this;
+    }
+
+    MultivariatePolynomial& operator -= (const MultivariatePolynomial& other) {
+        terms = polynomial_kernels::mergeTerms(terms, other.terms, T(-1));
+        return *this;
+    }
+
+    // Произведение в заданном числе потоков (см. polynomial_kernels::multiplyTermsParallel).
+    // Результат не зависит от числа потоков.
+    friend MultivariatePolynomial multiply(const MultivariatePolynomial& a, const MultivariatePolynomial& b,
+                                           size_t threads) {
+        MultivariatePolynomial result;
+        result.terms = polynomial_kernels::multiplyTermsParallel(a.terms, b.terms, [](uint64_t x, uint64_t y) {
+            return Packing::multiply(x, y);
+        }, threads);
+        return result;
+    }
+
+    friend MultivariatePolynomial operator * (const MultivariatePolynomial& a, const MultivariatePolynomial& b) {
+        return multiply(a, b, polynomial_kernels::defaultThreads());
+    }
+
+    MultivariatePolynomial& operator *= (const MultivariatePolynomial& other) {
+        return *this = *this * other;
+    }
+
+    MultivariatePolynomial& operator *= (const T& scalar) {
+        std::vector<Term> scaled;
+        scaled.reserve(terms.size());
+        for (const auto& t : terms)
+            if (t.second * scalar != T(0))
+                scaled.emplace_back(t.first, t.second * scalar);
+        terms = std::move(scaled);
+        return *this;
+    }
+
+    friend MultivariatePolynomial operator + (MultivariatePolynomial a, const MultivariatePolynomial& b) {
+        return a += b;
+    }
+
+    friend MultivariatePolynomial operator - (MultivariatePolynomial a, const MultivariatePolynomial& b) {
+        return a -= b;
+    }
+};
+
+// Члены от старшего одночлена к младшему, переменные - x1, ..., xN: x1^2*x3-2*x2+1
+template <typename T, size_t N>
+std::ostream& operator << (std::ostream& out, const MultivariatePolynomial<T, N>& p) {
+    typedef MonomialPacking<N> Packing;
+    if (p.begin() == p.end())
+        return out << T(0);
+    for (auto it = p.end(); it != p.begin(); ) {
+        --it;
+        bool times = printCoefficient(out, it->second, it + 1 == p.end(), it->first == 0);
+        for (size_t i = 0; i != N; ++i) {
+            const int e = Packing::exponent(it->first, i);
+            if (e == 0)
+                continue;
+            if (times)
+                out << '*';
+            out << 'x' << i + 1;
+            if (e > 1)
+                out << '^' << e;
+            times = true;
+        }
+    }
+    return out;
+}
+
+// Рациональная функция numerator / denominator (задача A4).
+//
+// Сокращение на НОД - самая дорогая операция: алгоритм Евклида на каждом шаге создаёт новые многочлены.
+// Поэтому сокращаем лениво: при выводе и когда суммарная степень переросла ReduceDegree и вдвое
+// превысила степень после прошлого сокращения. Иначе несократимая дробь большой степени пересчитывала бы
+// НОД при каждой операции, и ленивое сокращение стоило бы дороже немедленного.
+// Сравнение идёт крест-накрест (a/b == c/d, если ad == cb) и сокращения не требует.
+// Составные операторы меняют числитель и знаменатель на месте; при равных знаменателях
+// (частый случай в суммах) += и -= сводятся к сложению числителей без умножений и новых буферов.
+template <typename T>
+class Fraction {
+private:
+    Polynomial<T> numerator, denominator;
+    int reducedDegree = 0;  // суммарная степень сразу после последнего сокращения
+
+    static const int ReduceDegree = 64;
+
+    // Делит и числитель, и знаменатель на их НОД. Для целых коэффициентов НОД считается с округлением
+    // при делении и может не делить многочлены нацело - тогда оставляем дробь как есть.
+    // Затем нормируем знаменатель: над полем - старший коэффициент 1, для целых - положительный.
+    void reduce() {
+        if (numerator.Degree() < 0) {
+            denominator = T(1);
+            reducedDegree = 0;
+            return;
+        }
+        const Polynomial<T> g = (numerator, denominator);
+        if (g.Degree() > 0) {
+            Polynomial<T> n = numerator / g, d = denominator / g;
+            if (!std::is_integral<T>::value || (n * g == numerator && d * g == denominator)) {
+                numerator = std::move(n);
+                denominator = std::move(d);
+            }
+        }
+        const T lead = denominator[denominator.Degree()];
+        if constexpr (std::is_integral<T>::value) {
+            if (lead < T(0)) {
+                numerator *= T(-1);
+                denominator *= T(-1);
+            }
+        } else if (lead != T(1)) {
+            const T inverse = T(1) / lead;
+            numerator *= inverse;
+            denominator *= inverse;
+        }
+        reducedDegree = numerator.Degree() + denominator.Degree();
+    }
+
+    void reduceIfLarge() {
+        const int degree = numerator.Degree() + denominator.Degree();
+        if (degree > ReduceDegree && degree > 2 * reducedDegree)
+            reduce();
+    }
+
+public:
+    // Степень исходной дроби считаем отправной точкой: сокращать будем, когда она вырастет вдвое
+    Fraction(const std::vector<T>& n, const std::vector<T>& d): numerator(n), denominator(d) {
+        if (denominator.Degree() < 0)
+            throw ZeroDivisionException();
+        reducedDegree = std::max(numerator.Degree(), 0) + denominator.Degree();
+    }
+
+    Fraction(const Polynomial<T>& n, const Polynomial<T>& d = T(1)): numerator(n), denominator(d) {
+        if (denominator.Degree() < 0)
+            throw ZeroDivisionException();
+        reducedDegree = std::max(numerator.Degree(), 0) + denominator.Degree();
+    }
+
+    Fraction(const T& c = T()): numerator(c), denominator(T(1)) {
+    }
+
+    const Polynomial<T>& Numerator() const {
+        return numerator;
+    }
+
+    const Polynomial<T>& Denominator() const {
+        return denominator;
+    }
+
+    // Сократить прямо сейчас (например, перед тем как отдать числитель и знаменатель наружу)
+    Fraction& Reduce() {
+        reduce();
+        return *this;
+    }
+
+    friend bool operator == (const Fraction& a, const Fraction& b) {
+        if (a.denominator == b.denominator)
+            return a.numerator == b.numerator;
+        return a.numerator * b.denominator == b.numerator * a.denominator;
+    }
+
+    friend bool operator != (const Fraction& a, const Fraction& b) {
+        return !(a == b);
+    }
+
+    Fraction& operator += (const Fraction& other) {
+        if (denominator == other.denominator) {
+            numerator += other.numerator;
+        } else {
+            numerator *= other.denominator;
+            numerator += other.numerator * denominator;
+            denominator *= other.denominator;
+        }
+        reduceIfLarge();
+        return *this;
+    }
+
+    Fraction& operator -= (const Fraction& other) {
+        if (denominator == other.denominator) {
+            numerator -= other.numerator;
+        } else {
+            numerator *= other.denominator;
+            numerator -= other.numerator * denominator;
+            denominator *= other.denominator;
+        }
+        reduceIfLarge();
+        return *this;
+    }
+
+    Fraction& operator *= (const Fraction& other) {
+        numerator *= other.numerator;
+        denominator *= other.denominator;
+        reduceIfLarge();
+        return *this;
+    }
+
+    Fraction& operator /= (const Fraction& other) {
+        if (other.numerator.Degree() < 0)
+            throw ZeroDivisionException();
+        const Polynomial<T> divisor = other.numerator;  // other может совпадать с *this
+        numerator *= other.denominator;
+        denominator *= divisor;
+        reduceIfLarge();
+        return *this;
+    }
+
+    friend Fraction operator + (Fraction a, const Fraction& b) {
+        return a += b;
+    }
+
+    friend Fraction operator - (Fraction a, const Fraction& b) {
+        return a -= b;
+    }
+
+    friend Fraction operator * (Fraction a, const Fraction& b) {
+        return a *= b;
+    }
+
+    friend Fraction operator / (Fraction a, const Fraction& b) {
+        return a /= b;
+    }
+};
+
+// Выводим сокращённую дробь: (x+1)/(x^2-2), а при знаменателе 1 - только числитель
+template <typename T>
+std::ostream& operator << (std::ostream& out, const Fraction<T>& f) {
+    Fraction<T> reduced = f;
+    reduced.Reduce();
+    if (reduced.Denominator() == Polynomial<T>(T(1)))
+        return out << reduced.Numerator();
+    return out << '(' << reduced.Numerator() << ")/(" << reduced.Denominator() << ')';
+}
+
+// Многочлен фиксированной длины N с коэффициентами-константами: constexpr FixedPolynomial exp3{1.0, 1.0, 0.5, 1.0 / 6};
+// Интерфейс тот же, что у Polynomial из A1_test.cpp, только N - это длина массива, а не степень:
+// старшие коэффициенты могут быть нулями. Все операции constexpr, так что такой многочлен можно
+// построить и даже вычислить при компиляции.
+//
+// Значение считается по схеме Эстрина: p(x) = (c0 + c1 x) + x^2 (c2 + c3 x) + x^4 (...) + ...
+// Горнер - это цепочка из N зависимых умножений, а здесь дерево глубины log N, и умножения на одном уровне
+// процессор выполняет одновременно. Рекурсия идёт по индексам-параметрам шаблона и раскрывается при компиляции:
+// в коде остаются только умножения и сложения с коэффициентами-константами.
+template <typename T, size_t N>
+class FixedPolynomial {
+    static_assert(N >= 1, "FixedPolynomial: нужен хотя бы один коэффициент");
+
+private:
+    std::array<T, N> coefficients;
+
+    // Наибольшая степень двойки, меньшая n (n >= 2): левая часть разбиения всегда полная
+    static constexpr size_t split(size_t n) {
+        size_t half = 1;
+        while (2 * half < n)
+            half *= 2;
+        return half;
+    }
+
+    static constexpr size_t log2(size_t n) {
+        size_t k = 0;
+        while ((size_t(1) << k) < n)
+            ++k;
+        return k;
+    }
+
+    // Сколько степеней x, x^2, x^4, ... понадобится Эстрину
+    static constexpr size_t Levels = N == 1 ? 1 : log2(split(N)) + 1;
+
+    // powers[k] = powers[k - 1]^2 начиная с K. Тоже рекурсией, а не циклом: иначе в пакетном operator ()
+    // внутри векторизуемого цикла по точкам оказался бы вложенный цикл, и GCC отказался бы его векторизовать.
+    template <size_t K>
+    static constexpr void square(std::array<T, Levels>& powers) {
+        if constexpr (K < Levels) {
+            powers[K] = powers[K - 1] * powers[K - 1];
+            square<K + 1>(powers);
+        }
+    }
+
+    // Сумма c[Begin + i] x^i по i < Count; powers[k] = x^(2^k)
+    template <size_t Begin, size_t Count>
+    constexpr T estrin(const std::array<T, Levels>& powers) const {
+        if constexpr (Count == 1) {
+            return coefficients[Begin];
+        } else {
+            constexpr size_t Half = split(Count);
+            return estrin<Begin, Half>(powers) + powers[log2(Half)] * estrin<Begin + Half, Count - Half>(powers);
+        }
+    }
+
+public:
+    constexpr FixedPolynomial(): coefficients() {
+    }
+
+    constexpr FixedPolynomial(const std::array<T, N>& c): coefficients(c) {
+    }
+
+    // Из более короткого многочлена: старшие коэффициенты - нули
+    template <size_t M, typename = std::enable_if_t<(M < N)>>
+    explicit constexpr FixedPolynomial(const FixedPolynomial<T, M>& other): coefficients() {
+        for (size_t i = 0; i != M; ++i)
+            coefficients[i] = other[i];
+    }
+
+    // Коэффициенты начиная с младшей степени, как в векторе у Polynomial; недостающие старшие - нули
+    template <typename... U, typename = std::enable_if_t<sizeof...(U) < N>>
+    constexpr FixedPolynomial(const T& c0, const U&... c): coefficients{c0, T(c)...} {
+    }
+
+    constexpr int Degree() const {
+        for (size_t i = N; i-- > 0; )
+            if (coefficients[i] != T(0))
+                return static_cast<int>(i);
+        return -1;
+    }
+
+    constexpr T operator [] (size_t i) const {
+        return i < N ? coefficients[i] : T(0);
+    }
+
+    constexpr typename std::array<T, N>::const_iterator begin() const {
+        return coefficients.begin();
+    }
+
+    constexpr typename std::array<T, N>::const_iterator end() const {
+        return coefficients.end();
+    }
+
+    constexpr T operator () (const T& x) const {
+        std::array<T, Levels> powers{};
+        powers[0] = x;
+        square<1>(powers);
+        return estrin<0, N>(powers);
+    }
+
+    // Значения во многих точках. Точки независимы, поэтому идём порциями по Lanes через __restrict-указатели
+    // (как polynomial_kernels::evaluateHorner): GCC векторизует порцию целиком, по точке на элемент регистра.
+    std::vector<T> operator () (const std::vector<T>& points) const {
+        const size_t Lanes = 16;
+        std::vector<T> values(points.size());
+        const T * __restrict x = points.data();
+        T * __restrict out = values.data();
+        size_t i = 0;
+        for (; i + Lanes <= points.size(); i += Lanes)
+            for (size_t t = 0; t != Lanes; ++t)
+                out[i + t] = (*this)(x[i + t]);
+        for (; i != points.size(); ++i)
+            out[i] = (*this)(x[i]);
+        return values;
+    }
+
+    // Динамический многочлен с теми же коэффициентами: для деления, НОД и прочего, чего здесь нет
+    operator Polynomial<T> () const {
+        return Polynomial<T>(coefficients.begin(), coefficients.end());
+    }
+
+    template <size_t M>
+    friend constexpr bool operator == (const FixedPolynomial& a, const FixedPolynomial<T, M>& b) {
+        for (size_t i = 0; i != std::max(N, M); ++i)
+            if (a[i] != b[i])
+                return false;
+        return true;
+    }
+
+    template <size_t M>
+    friend constexpr bool operator != (const FixedPolynomial& a, const FixedPolynomial<T, M>& b) {
+        return !(a == b);
+    }
+
+    template <size_t M>
+    constexpr FixedPolynomial& operator += (const FixedPolynomial<T, M>& other) {
+        static_assert(M <= N, "FixedPolynomial: слагаемое длиннее результата");
+        for (size_t i = 0; i != M; ++i)
+            coefficients[i] += other[i];
+        return *this;
+    }
+
+    template <size_t M>
+    constexpr FixedPolynomial& operator -= (const FixedPolynomial<T, M>& other) {
+        static_assert(M <= N, "FixedPolynomial: вычитаемое длиннее результата");
+        for (size_t i = 0; i != M; ++i)
+            coefficients[i] -= other[i];
+        return *this;
+    }
+
+    constexpr FixedPolynomial& operator *= (const T& scalar) {
+        for (auto& c : coefficients)
+            c *= scalar;
+        return *this;
+    }
+
+    // Длина результата тоже вычисляется при компиляции: max(N, M) у суммы и N + M - 1 у произведения
+    template <size_t M>
+    friend constexpr FixedPolynomial<T, std::max(N, M)> operator + (const FixedPolynomial& a, const FixedPolynomial<T, M>& b) {
+        FixedPolynomial<T, std::max(N, M)> result(a);
+        return result += b;
+    }
+
+    template <size_t M>
+    friend constexpr FixedPolynomial<T, std::max(N, M)> operator - (const FixedPolynomial& a, const FixedPolynomial<T, M>& b) {
+        FixedPolynomial<T, std::max(N, M)> result(a);
+        return result -= b;
+    }
+
+    template <size_t M>
+    friend constexpr FixedPolynomial<T, N + M - 1> operator * (const FixedPolynomial& a, const FixedPolynomial<T, M>& b) {
+        std::array<T, N + M - 1> c{};
+        for (size_t i = 0; i != N; ++i)
+            for (size_t j = 0; j != M; ++j)
+                c[i + j] += a[i] * b[j];
+        return FixedPolynomial<T, N + M - 1>(c);
+    }
+};
+
+// FixedPolynomial p{1.0, 2.0, 3.0} - это FixedPolynomial<double, 3>
+template <typename T, typename... U>
+FixedPolynomial(T, U...) -> FixedPolynomial<T, 1 + sizeof...(U)>;
+
+template <typename T, size_t N>
+std::ostream& operator << (std::ostream& out, const FixedPolynomial<T, N>& p) {
+    return out << Polynomial<T>(p);
+}
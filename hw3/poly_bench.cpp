@@ -0,0 +1,786 @@
+// Замеры производительности для Polynomial<T>: по ним подобраны пороги в polynomial_kernels.
+// Сборка: g++ -std=c++17 -O2 -march=native -pthread poly_bench.cpp -o poly_bench
+// Запуск: ./poly_bench [thresholds | large | division | gcd | evaluate | multivariate | parallel | fraction | properties | fixed | all]
+// Результаты печатаются построчно, поля разделены табуляцией: их удобно читать скриптом.
+
+#include "poly.h"
+#include "../2019-1/modint.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Счётчик выделений памяти: все operator new в программе (и new[], который вызывает его) проходят здесь.
+// noinline - чтобы GCC не подставлял free в код, где видит new, и не предупреждал о несовпадении пар.
+std::atomic<size_t> allocations(0);
+
+[[gnu::noinline]] void * operator new (size_t size) {
+    ++allocations;
+    if (void * p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete (void * p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete (void * p, size_t) noexcept {
+    std::free(p);
+}
+
+template <typename Function>
+double measureSeconds(Function f, size_t repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r != repeats; ++r)
+        f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+// Не даём компилятору выбросить вычисление, результат которого никто не читает (как keep в 2019-1/bench.cpp)
+template <typename T>
+void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const T * volatile sink;
+    sink = &value;
+#endif
+}
+
+template <typename T>
+std::vector<T> randomCoefficients(size_t size, long long range) {
+    std::mt19937_64 generator(size);
+    std::uniform_int_distribution<long long> distribution(-range, range);
+    std::vector<T> v(size);
+    for (auto& x : v)
+        x = T(distribution(generator));
+    return v;
+}
+
+// Каждый алгоритм отдельно, в обход автоматического выбора
+template <typename T>
+std::vector<T> multiplySchoolbook(const std::vector<T>& a, const std::vector<T>& b) {
+    std::vector<T> out(a.size() + b.size() - 1, T(0));
+    polynomial_kernels::addProductSchoolbook(a.data(), a.size(), b.data(), b.size(), out.data());
+    return out;
+}
+
+template <typename T>
+std::vector<T> multiplyKaratsuba(const std::vector<T>& a, const std::vector<T>& b) {
+    std::vector<T> out(a.size() + b.size() - 1, T(0));
+    polynomial_kernels::addProductUnbalanced(a.data(), a.size(), b.data(), b.size(), out.data());
+    return out;
+}
+
+template <typename T>
+std::vector<T> multiplyTransform(const std::vector<T>& a, const std::vector<T>& b) {
+    std::vector<T> out(a.size() + b.size() - 1, T(0));
+    polynomial_kernels::multiplyTransform(a, b, out);
+    return out;
+}
+
+template <typename T, typename Multiply>
+void benchAlgorithm(const char * type, const char * algorithm, size_t n, long long range, Multiply multiply) {
+    const auto a = randomCoefficients<T>(n, range);
+    const auto b = randomCoefficients<T>(n + 1, range);
+    const size_t repeats = (1 << 22) / (n * n) + 1;
+    double seconds = measureSeconds([&] {
+        keep(multiply(a, b));
+    }, repeats);
+    std::cout << "multiply\t" << type << "\t" << algorithm << "\t" << n << "\t" << seconds * 1e6 << "\n";
+}
+
+// Для каждой длины сравниваем все применимые алгоритмы: точка, где кривые пересекаются, и есть порог
+template <typename T>
+void benchThresholds(const char * type, long long range) {
+    for (size_t n : {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192}) {
+        benchAlgorithm<T>(type, "schoolbook", n, range, multiplySchoolbook<T>);
+        benchAlgorithm<T>(type, "karatsuba", n, range, multiplyKaratsuba<T>);
+        benchAlgorithm<T>(type, "transform", n, range, multiplyTransform<T>);
+        benchAlgorithm<T>(type, "auto", n, range, polynomial_kernels::multiply<T>);
+    }
+}
+
+void runThresholds() {
+    std::cout << "# multiply\ttype\talgorithm\tn\tus\n";
+    benchThresholds<int>("int", 1000);
+    benchThresholds<long long>("int64", 1000000000);
+    benchThresholds<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+    benchThresholds<ModInt<998244353>>("mod_998244353", 998244352);
+    benchThresholds<double>("double", 1000);
+}
+
+// Многочлены с миллионом коэффициентов: здесь работают только NTT и FFT
+template <typename T>
+void benchLarge(const char * type, long long range) {
+    for (size_t n : {1 << 16, 1 << 18, 1 << 20}) {
+        const Polynomial<T> p(randomCoefficients<T>(n, range));
+        const Polynomial<T> q(randomCoefficients<T>(n, range));
+        double seconds = measureSeconds([&] {
+            keep(p * q);
+        }, 1);
+        std::cout << "large\t" << type << "\t" << n << "\t" << seconds * 1e3 << "\n";
+    }
+}
+
+void runLarge() {
+    std::cout << "# large\ttype\tn\tms\n";
+    benchLarge<long long>("int64", 1000000);
+    benchLarge<ModInt<998244353>>("mod_998244353", 998244352);
+    benchLarge<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+    benchLarge<double>("double", 1000);
+}
+
+// Деление многочлена длины 2n на многочлен длины n: "столбиком" и через обращение ряда методом Ньютона.
+// Для целых чисел замеряем только "столбик": обратный ряд у них переполняется (см. divideNewton в poly.h).
+template <typename T>
+void benchDivision(const char * type, long long range) {
+    for (size_t n : {64, 128, 256, 512, 1024, 2048, 4096, 8192}) {
+        const auto a = randomCoefficients<T>(2 * n, range);
+        auto b = randomCoefficients<T>(n, range);
+        b.back() = T(1);
+        const size_t repeats = (1 << 22) / (n * n) + 1;
+        double seconds = measureSeconds([&] {
+            keep(polynomial_kernels::divideLong(a, b));
+        }, repeats);
+        std::cout << "divide\t" << type << "\tlong\t" << n << "\t" << seconds * 1e6 << "\n";
+        if (std::is_integral<T>::value)
+            continue;
+        seconds = measureSeconds([&] {
+            keep(polynomial_kernels::divideNewton(a, b));
+        }, repeats);
+        std::cout << "divide\t" << type << "\tnewton\t" << n << "\t" << seconds * 1e6 << "\n";
+    }
+}
+
+void runDivision() {
+    std::cout << "# divide\ttype\talgorithm\tn\tus\n";
+    benchDivision<long long>("int64", 1000);
+    benchDivision<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+    benchDivision<ModInt<998244353>>("mod_998244353", 998244352);
+    benchDivision<double>("double", 1000);
+}
+
+// НОД двух многочленов степени около n с общим делителем степени n / 2: Евклид и half-gcd
+template <typename T>
+void benchGcd(const char * type, long long range) {
+    for (size_t n : {1024, 2048, 4096, 8192, 16384}) {
+        const Polynomial<T> common(randomCoefficients<T>(n / 2, range));
+        const Polynomial<T> a = common * Polynomial<T>(randomCoefficients<T>(n / 2 + 1, range));
+        const Polynomial<T> b = common * Polynomial<T>(randomCoefficients<T>(n / 2, range));
+        double seconds = measureSeconds([&] {
+            keep(polynomial_kernels::gcdEuclid(a, b));
+        }, 1);
+        std::cout << "gcd\t" << type << "\teuclid\t" << n << "\t" << seconds * 1e6 << "\n";
+        seconds = measureSeconds([&] {
+            keep(polynomial_kernels::gcdHalf(a, b));
+        }, 1);
+        std::cout << "gcd\t" << type << "\thalf_gcd\t" << n << "\t" << seconds * 1e6 << "\n";
+    }
+}
+
+void runGcd() {
+    std::cout << "# gcd\ttype\talgorithm\tn\tus\n";
+    benchGcd<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+    benchGcd<ModInt<998244353>>("mod_998244353", 998244352);
+}
+
+// Значения многочлена степени n в count точках: по одной точке, схема Горнера по нескольким точкам сразу
+// и дерево подпроизведений (только для вычетов). Печатаем число точек в секунду.
+template <typename T>
+void benchEvaluate(const char * type, long long range) {
+    const size_t count = 1 << 15;
+    const auto points = randomCoefficients<T>(count, range);
+    for (size_t n : {16, 256, 4096, 16384}) {
+        const Polynomial<T> p(randomCoefficients<T>(n, range));
+        const std::vector<T> c(p.begin(), p.end());
+        const size_t repeats = (1 << 26) / (n * count) + 1;
+        auto report = [&](const char * algorithm, double seconds) {
+            std::cout << "evaluate\t" << type << "\t" << algorithm << "\t" << n << "\t" << count << "\t" << count / seconds << "\n";
+        };
+
+        T sink = T(0);
+        report("single", measureSeconds([&] {
+            for (const auto& x : points)
+                sink += p(x);
+        }, repeats));
+        std::vector<T> values(count);
+        report("batch", measureSeconds([&] {
+            polynomial_kernels::evaluateHorner(c.data(), c.size(), points.data(), values.data(), count);
+            keep(values);
+        }, repeats));
+        if constexpr (polynomial_kernels::HasModulus<T>::value) {
+            report("tree", measureSeconds([&] {
+                for (size_t start = 0; start < count; start += n) {
+                    const size_t block = std::min(n, count - start);
+                    polynomial_kernels::SubproductTree<T>(points.data() + start, block).evaluate(c, values.data() + start);
+                }
+                keep(values);
+            }, 1));
+        }
+        keep(sink);
+    }
+}
+
+void runEvaluate() {
+    std::cout << "# evaluate\ttype\talgorithm\tn\tpoints\tpoints/s\n";
+    benchEvaluate<long long>("int64", 1000);
+    benchEvaluate<double>("double", 1);
+    benchEvaluate<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+    benchEvaluate<ModInt<998244353>>("mod_998244353", 998244352);
+}
+
+// Прежнее устройство многочлена от N переменных: std::map от вектора степеней к коэффициенту.
+// Каждое сравнение ключей в дереве - это сравнение массивов из N чисел.
+template <typename T, size_t N>
+std::map<std::array<int, N>, T> multiplyMap(const std::map<std::array<int, N>, T>& a,
+                                            const std::map<std::array<int, N>, T>& b) {
+    std::map<std::array<int, N>, T> result;
+    for (const auto& [ma, ca] : a)
+        for (const auto& [mb, cb] : b) {
+            std::array<int, N> m;
+            for (size_t i = 0; i != N; ++i)
+                m[i] = ma[i] + mb[i];
+            result[m] += ca * cb;
+        }
+    for (auto it = result.begin(); it != result.end(); )
+        it = it->second == T(0) ? result.erase(it) : std::next(it);
+    return result;
+}
+
+// Плотные многочлены от трёх переменных: все одночлены со степенью каждой переменной меньше d
+template <typename T>
+std::map<std::array<int, 3>, T> denseMonomials(int d, long long range) {
+    const auto c = randomCoefficients<T>(d * d * d, range);
+    std::map<std::array<int, 3>, T> result;
+    for (int i = 0; i != d; ++i)
+        for (int j = 0; j != d; ++j)
+            for (int k = 0; k != d; ++k)
+                result[{i, j, k}] = c[(i * d + j) * d + k];
+    return result;
+}
+
+template <typename T>
+void benchMultivariate(const char * type, long long range) {
+    for (int d : {4, 8, 12, 16}) {
+        const auto a = denseMonomials<T>(d, range), b = denseMonomials<T>(d + 1, range);
+        const MultivariatePolynomial<T, 3> p(a), q(b);
+        const double pairs = double(a.size()) * b.size();
+        double seconds = measureSeconds([&] {
+            keep(multiplyMap(a, b));
+        }, 1);
+        std::cout << "multivariate\t" << type << "\tmap\t" << a.size() << "\t" << seconds * 1e3 << "\t" << pairs / seconds << "\n";
+        seconds = measureSeconds([&] {
+            keep(p * q);
+        }, 1);
+        std::cout << "multivariate\t" << type << "\tpacked\t" << a.size() << "\t" << seconds * 1e3 << "\t" << pairs / seconds << "\n";
+    }
+}
+
+void runMultivariate() {
+    std::cout << "# multivariate\ttype\timplementation\tterms\tms\tpairs/s\n";
+    benchMultivariate<long long>("int64", 1000);
+    benchMultivariate<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+}
+
+// Масштабирование многопоточного умножения: время и ускорение относительно одного потока.
+// Ускорение ограничено числом ядер машины (std::thread::hardware_concurrency печатается в заголовке).
+template <typename T>
+void benchParallel(const char * type, const char * shape, const MultivariatePolynomial<T, 3>& p,
+                   const MultivariatePolynomial<T, 3>& q) {
+    double single = 0;
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        const double seconds = measureSeconds([&] {
+            keep(multiply(p, q, threads));
+        }, 1);
+        if (threads == 1)
+            single = seconds;
+        std::cout << "parallel\t" << type << "\t" << shape << "\t" << threads << "\t" << seconds * 1e3 << "\t" << single / seconds << "\n";
+    }
+}
+
+void runParallel() {
+    std::cout << "# parallel\ttype\tshape\tthreads\tms\tspeedup\t(cores: " << std::thread::hardware_concurrency() << ")\n";
+    // Плотные: 4096 x 4913 членов, у произведения всего 35937 одночленов
+    const MultivariatePolynomial<long long, 3> a(denseMonomials<long long>(16, 1000)), b(denseMonomials<long long>(17, 1000));
+    benchParallel<long long>("int64", "dense", a, b);
+    // Разреженные: 2000 x 2000 случайных одночленов, почти все произведения различны
+    std::mt19937_64 generator(1);
+    std::map<std::array<int, 3>, long long> c, d;
+    while (c.size() != 2000)
+        c[{int(generator() % 1000), int(generator() % 1000), int(generator() % 1000)}] = 1 + generator() % 1000;
+    while (d.size() != 2000)
+        d[{int(generator() % 1000), int(generator() % 1000), int(generator() % 1000)}] = 1 + generator() % 1000;
+    benchParallel<long long>("int64", "sparse", MultivariatePolynomial<long long, 3>(c), MultivariatePolynomial<long long, 3>(d));
+}
+
+// Выражения из A4_test.cpp над дробями со знаменателями степени n. settle вызывается после каждой операции:
+// при "eager" он сокращает дробь сразу (как делала бы нормализация в каждом операторе), при "lazy" ничего не делает.
+template <typename T, typename Settle>
+bool fractionIdentities(const Fraction<T>& p, const Fraction<T>& q, Settle settle) {
+    auto sum = settle(p + q), diff = settle(p - q);
+    bool ok = settle(sum + diff) == settle(p + p) && settle(sum - diff) == settle(q + q);
+    auto squares = settle(settle(p * p) - settle(q * q));
+    ok = ok && squares == settle(sum * diff) && settle(squares / diff) == sum;
+    ok = ok && settle(settle(p / q) * settle(q / p)) == Fraction<T>(1);
+    diff -= p;
+    settle(diff);
+    diff *= T(-1);
+    return ok && settle(diff) == q;
+}
+
+template <typename T>
+void benchFraction(const char * type, long long range) {
+    for (size_t n : {2, 8, 32, 128}) {
+        const Fraction<T> p(randomCoefficients<T>(n, range), randomCoefficients<T>(n + 1, range));
+        const Fraction<T> q(randomCoefficients<T>(n + 2, range), randomCoefficients<T>(n + 3, range));
+        auto run = [&](const char * mode, auto settle) {
+            const size_t repeats = (1 << 16) / (n * n) + 1;
+            bool ok = true;
+            const size_t before = allocations;
+            const double seconds = measureSeconds([&] {
+                ok = fractionIdentities(p, q, settle) && ok;
+            }, repeats);
+            std::cout << "fraction\t" << type << "\t" << mode << "\t" << n << "\t" << seconds * 1e6 << "\t"
+                      << (allocations - before) / repeats << "\t" << ok << "\n";
+        };
+        run("eager", [](Fraction<T> f) {
+            return f.Reduce();
+        });
+        run("lazy", [](Fraction<T> f) {
+            return f;
+        });
+    }
+}
+
+void runFraction() {
+    std::cout << "# fraction\ttype\tnormalization\tn\tus\tallocations\tok\n";
+    benchFraction<ModInt<998244353>>("mod_998244353", 998244352);
+    benchFraction<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+}
+
+// Свойства операций на случайных многочленах заданной степени и разреженности.
+// Каждая операция замеряется, а её результат проверяется тождеством, как в A1_test.cpp - A4_test.cpp:
+// ok = 0 в строке означает, что тождество нарушено. Одни и те же многочлены прогоняются через разные
+// представления (Polynomial и SparsePolynomial; MultivariatePolynomial и подстановку Кронекера в Polynomial),
+// поэтому по строкам с одинаковой степенью видно, с какой плотности выгоднее какое представление.
+
+// Времена операций здесь отличаются на много порядков, поэтому повторяем, пока не наберётся 20 мс.
+// Число повторов ограничено: если операция всё-таки оказалась пустой, замер не должен зацикливаться.
+template <typename Function>
+double measureAdaptive(Function f) {
+    const size_t MaxRepeats = size_t(1) << 24;
+    for (size_t repeats = 1; ; repeats *= 4) {
+        const double seconds = measureSeconds(f, repeats);
+        if (seconds * repeats >= 0.02 || repeats >= MaxRepeats)
+            return seconds;
+    }
+}
+
+template <typename T>
+T randomNonzero(std::mt19937_64& generator, long long range) {
+    return T(static_cast<long long>(1 + generator() % range));
+}
+
+// Точка для проверки значений. У целых x^degree переполняется уже при |x| = 2, у double уходит в бесконечность,
+// поэтому для них берём +-1; у вычетов подойдёт любая. Для double именно 1: коэффициенты положительны,
+// значение - сумма без сокращений, и шум FFT в нулевых коэффициентах на его фоне не виден.
+template <typename T>
+T probePoint(std::mt19937_64& generator, long long range) {
+    if constexpr (std::is_integral<T>::value)
+        return T(-1);
+    else if constexpr (std::is_floating_point<T>::value)
+        return T(1);
+    else
+        return randomNonzero<T>(generator, range);
+}
+
+// Сравнение результатов: точное для целых и вычетов
+struct Exactly {
+    template <typename U>
+    bool operator () (const U& a, const U& b) const {
+        return a == b;
+    }
+};
+
+// и с относительной погрешностью для double: FFT и деление через ряд округляют каждый коэффициент
+struct Approximately {
+    double tolerance;
+
+    bool operator () (double a, double b) const {
+        return std::abs(a - b) <= tolerance * std::max({1.0, std::abs(a), std::abs(b)});
+    }
+
+    bool operator () (const Polynomial<double>& a, const Polynomial<double>& b) const {
+        double scale = 1, error = 0;
+        for (int i = 0; i <= std::max(a.Degree(), b.Degree()); ++i) {
+            scale = std::max({scale, std::abs(a[i]), std::abs(b[i])});
+            error = std::max(error, std::abs(a[i] - b[i]));
+        }
+        return error <= tolerance * scale;
+    }
+};
+
+// Ровно terms ненулевых членов степени не выше degree, старший член x^degree есть всегда.
+// Остальные степени выбираются равномерно без повторов; terms = degree + 1 даёт плотный многочлен.
+template <typename T>
+std::vector<std::pair<size_t, T>> randomTerms(size_t degree, size_t terms, long long range, std::mt19937_64& generator) {
+    std::vector<char> used(degree + 1, 0);
+    std::vector<std::pair<size_t, T>> result{{degree, randomNonzero<T>(generator, range)}};
+    used[degree] = 1;
+    while (result.size() < std::min(terms, degree + 1)) {
+        const size_t e = generator() % degree;
+        if (!used[e]) {
+            used[e] = 1;
+            result.emplace_back(e, randomNonzero<T>(generator, range));
+        }
+    }
+    return result;
+}
+
+template <typename P, typename T>
+P fromTerms(const std::vector<std::pair<size_t, T>>& terms) {
+    if constexpr (std::is_same<P, Polynomial<T>>::value) {
+        std::vector<T> c;
+        for (const auto& [e, v] : terms) {
+            c.resize(std::max(c.size(), e + 1), T(0));
+            c[e] = v;
+        }
+        return P(c);
+    } else {
+        return P(terms);
+    }
+}
+
+void reportProperty(const char * type, const char * representation, size_t degree, size_t terms,
+                    const char * operation, double seconds, bool ok) {
+    std::cout << "property\t" << type << "\t" << representation << "\t" << degree << "\t" << terms << "\t"
+              << operation << "\t" << seconds * 1e6 << "\t" << ok << "\n";
+}
+
+// p и q степени degree, r - степени deg q - 1 (остаток), g - степени degree / 2 (общий делитель для НОД).
+// same сравнивает и многочлены, и значения в точке.
+template <typename P, typename T, typename Same>
+void checkUnivariate(const char * type, const char * representation, size_t degree, size_t terms,
+                     const P& p, const P& q, const P& r, const P& g, T x, bool withGcd, Same same) {
+    auto report = [&](const char * operation, double seconds, bool ok) {
+        reportProperty(type, representation, degree, terms, operation, seconds, ok);
+    };
+
+    P sum, diff;
+    double seconds = measureAdaptive([&] {
+        sum = p + q;
+        diff = p - q;
+    });
+    P f = diff;
+    (f -= p) *= T(-1);
+    report("add", seconds, same(sum + diff, p + p) && same(sum - diff, q + q) && same(f, q));
+
+    T value = T(0);
+    seconds = measureAdaptive([&] {
+        value += p(x);
+        keep(value);
+    });
+    report("evaluate", seconds, same(sum(x), p(x) + q(x)) && same(diff(x), p(x) - q(x)));
+
+    P product;
+    seconds = measureAdaptive([&] {
+        product = p * q;
+    });
+    report("multiply", seconds, same(p * p - q * q, sum * diff) && same(product(x), p(x) * q(x)));
+
+    const P a = product + r;
+    P quotient, remainder;
+    seconds = measureAdaptive([&] {
+        quotient = a / q;
+        remainder = a % q;
+    });
+    // Остаток сверяем через a = q * quotient + remainder: у double его погрешность соразмерна a, а не r
+    report("divide", seconds, same(quotient, p) && same(quotient * q + remainder, a) && remainder.Degree() < q.Degree());
+
+    if (withGcd) {
+        const P u = p * g, v = q * g;
+        P h;
+        seconds = measureAdaptive([&] {
+            h = (u, v);
+        });
+        report("gcd", seconds, (h % g).Degree() < 0 && (u % h).Degree() < 0 && (v % h).Degree() < 0);
+    }
+}
+
+// Степень 16384 не меньше newtonThreshold и transformThreshold всех проверяемых типов: на ней умножение идёт
+// через NTT или FFT, а деление над полем - через ряды. НОД имеет смысл только над полем, поэтому для целых
+// и double его не проверяем. Делитель для целых унитарный, иначе частное не целое.
+// У double старший коэффициент делителя больше суммы модулей остальных: тогда ряд 1 / rev(q) убывает,
+// и деление устойчиво к округлению. Разреженное представление для double не проверяем: для него
+// понадобилось бы ещё и приближённое сравнение SparsePolynomial.
+template <typename T, typename Same = Exactly>
+void propertiesUnivariate(const char * type, long long range, Same same = Same()) {
+    static_assert(polynomial_kernels::newtonThreshold<T>() <= 16384, "propertiesUnivariate: деление через ряды не проверяется");
+    const bool field = !std::is_arithmetic<T>::value;
+    for (size_t degree : {256, 2048, 16384}) {
+        for (size_t terms : {degree + 1, degree / 8, size_t(8)}) {
+            std::mt19937_64 generator(degree * 31 + terms);
+            const auto p = randomTerms<T>(degree, terms, range, generator);
+            auto q = randomTerms<T>(degree, terms, range, generator);
+            if (std::is_integral<T>::value)
+                q[0].second = T(1);
+            else if (std::is_floating_point<T>::value)
+                q[0].second = T(range) * T(terms + 1);
+            const auto r = randomTerms<T>(degree - 1, terms, range, generator);
+            const auto g = randomTerms<T>(degree / 2, terms, range, generator);
+            const T x = probePoint<T>(generator, range);
+            checkUnivariate(type, "dense", degree, terms, fromTerms<Polynomial<T>>(p), fromTerms<Polynomial<T>>(q),
+                            fromTerms<Polynomial<T>>(r), fromTerms<Polynomial<T>>(g), x, field, same);
+            // Кучей на плотных данных - O(n^2 log n), а Евклид над SparsePolynomial каждый шаг сливает весь остаток
+            if constexpr (!std::is_floating_point<T>::value) {
+                if (terms <= 4096)
+                    checkUnivariate(type, "sparse", degree, terms, fromTerms<SparsePolynomial<T>>(p),
+                                    fromTerms<SparsePolynomial<T>>(q), fromTerms<SparsePolynomial<T>>(r),
+                                    fromTerms<SparsePolynomial<T>>(g), x, field && degree <= 2048, same);
+            }
+        }
+    }
+}
+
+// Многочлены от двух переменных со степенью каждой переменной не выше d. Подстановка Кронекера
+// x^i y^j -> z^(i + j (2d + 1)) переводит их в Polynomial длины около 2 d^2 без наложения степеней в произведении:
+// её время от числа членов не зависит, а у MultivariatePolynomial растёт как квадрат числа членов.
+template <typename T>
+std::map<std::array<int, 2>, T> randomBivariate(int d, size_t terms, long long range, std::mt19937_64& generator) {
+    const auto flat = randomTerms<T>(size_t(d + 1) * (d + 1) - 1, terms, range, generator);
+    std::map<std::array<int, 2>, T> result;
+    for (const auto& [e, v] : flat)
+        result[{int(e % (d + 1)), int(e / (d + 1))}] = v;
+    return result;
+}
+
+template <typename T>
+Polynomial<T> kronecker(const std::map<std::array<int, 2>, T>& m, int d) {
+    std::vector<T> c(size_t(2 * d + 1) * (d + 1), T(0));
+    for (const auto& [e, v] : m)
+        c[e[0] + size_t(e[1]) * (2 * d + 1)] = v;
+    return Polynomial<T>(c);
+}
+
+template <typename T>
+MultivariatePolynomial<T, 2> unkronecker(const Polynomial<T>& p, int d) {
+    std::map<std::array<int, 2>, T> m;
+    for (int e = 0; e <= p.Degree(); ++e)
+        if (p[e] != T(0))
+            m[{e % (2 * d + 1), e / (2 * d + 1)}] = p[e];
+    return MultivariatePolynomial<T, 2>(m);
+}
+
+template <typename T>
+void propertiesMultivariate(const char * type, long long range) {
+    for (int d : {16, 64, 256}) {
+        const size_t dense = size_t(d + 1) * (d + 1);
+        for (size_t terms : {dense, dense / 16, size_t(64)}) {
+            std::mt19937_64 generator(d * 31 + terms);
+            const auto a = randomBivariate<T>(d, terms, range, generator);
+            const auto b = randomBivariate<T>(d, terms, range, generator);
+            const std::array<int, 2> point{int(generator() % 1000), int(generator() % 1000)};
+            auto report = [&](const char * representation, const char * operation, double seconds, bool ok) {
+                reportProperty(type, representation, d, terms, operation, seconds, ok);
+            };
+
+            const Polynomial<T> kp = kronecker(a, d), kq = kronecker(b, d);
+            Polynomial<T> kproduct;
+            double seconds = measureAdaptive([&] {
+                kproduct = kp * kq;
+            });
+            const MultivariatePolynomial<T, 2> p(a), q(b);
+            if (terms > 8192) {  // хеш-таблица на (d + 1)^4 пар не поместится в разумное время
+                report("kronecker", "multiply", seconds, kp * kp - kq * kq == (kp + kq) * (kp - kq));
+                continue;
+            }
+            const MultivariatePolynomial<T, 2> product = p * q;
+            report("kronecker", "multiply", seconds, unkronecker(kproduct, d) == product);
+
+            MultivariatePolynomial<T, 2> sum, diff;
+            seconds = measureAdaptive([&] {
+                sum = p + q;
+                diff = p - q;
+            });
+            report("multivariate", "add", seconds, sum + diff == p + p && sum - diff == q + q);
+            seconds = measureAdaptive([&] {
+                keep(p * q);
+            });
+            report("multivariate", "multiply", seconds,
+                   p * p - q * q == sum * diff && product(point) == p(point) * q(point));
+        }
+    }
+}
+
+// Дроби со знаменателями степени n: тождества из A4_test.cpp, по одному на операцию
+template <typename T>
+void propertiesFraction(const char * type, long long range) {
+    for (size_t n : {4, 16, 64, 256}) {
+        std::mt19937_64 generator(n);
+        const Fraction<T> p(fromTerms<Polynomial<T>>(randomTerms<T>(n - 1, n, range, generator)),
+                            fromTerms<Polynomial<T>>(randomTerms<T>(n, n + 1, range, generator)));
+        const Fraction<T> q(fromTerms<Polynomial<T>>(randomTerms<T>(n + 1, n + 2, range, generator)),
+                            fromTerms<Polynomial<T>>(randomTerms<T>(n, n + 1, range, generator)));
+        auto report = [&](const char * operation, double seconds, bool ok) {
+            reportProperty(type, "fraction", n, n + 1, operation, seconds, ok);
+        };
+
+        Fraction<T> sum, diff;
+        double seconds = measureAdaptive([&] {
+            sum = p + q;
+            diff = p - q;
+        });
+        Fraction<T> f = diff;
+        (f -= p) *= T(-1);
+        report("add", seconds, sum + diff == p + p && sum - diff == q + q && f == q);
+
+        Fraction<T> product;
+        seconds = measureAdaptive([&] {
+            product = p * q;
+        });
+        report("multiply", seconds, p * p - q * q == sum * diff);
+
+        Fraction<T> ratio;
+        seconds = measureAdaptive([&] {
+            ratio = p / q;
+        });
+        report("divide", seconds, ratio * (q / p) == Fraction<T>(1) && (p * p - q * q) / diff == sum);
+
+        Fraction<T> reduced = product;
+        seconds = measureAdaptive([&] {
+            reduced = product;
+            reduced.Reduce();
+        });
+        report("reduce", seconds, reduced == product && reduced.Denominator().Degree() <= product.Denominator().Degree());
+    }
+}
+
+void runProperties() {
+    std::cout << "# property\ttype\trepresentation\tdegree\tterms\toperation\tus\tok\n";
+    propertiesUnivariate<ModInt<998244353>>("mod_998244353", 998244352);
+    propertiesUnivariate<ModInt<1000000007>>("mod_1e9+7", 1000000006);
+    // Целые - как в задачах A1-A4: точное NTT по трём модулям и деление "столбиком"
+    propertiesUnivariate<long long>("int64", 1000);
+    propertiesUnivariate<double>("double", 1000, Approximately{1e-9});
+    propertiesMultivariate<ModInt<998244353>>("mod_998244353", 998244352);
+    propertiesFraction<ModInt<998244353>>("mod_998244353", 998244352);
+}
+
+// Многочлены-константы (FixedPolynomial): схема Эстрина против Горнера на тех же коэффициентах.
+// single - независимые точки по одной, chain - каждая следующая точка зависит от предыдущего значения
+// (так видна задержка, а не пропускная способность), batch - вектор точек целиком. Печатаем точки в секунду.
+template <typename T, size_t N>
+T hornerFixed(const FixedPolynomial<T, N>& p, const T& x) {
+    T result = T(0);
+    for (size_t i = N; i-- > 0; )
+        result = result * x + p[i];
+    return result;
+}
+
+// Ряд Тейлора для exp: приближение длины N, посчитанное при компиляции
+template <size_t N>
+constexpr FixedPolynomial<double, N> taylorExp() {
+    std::array<double, N> c{};
+    double factorial = 1;
+    for (size_t i = 0; i != N; ++i) {
+        c[i] = 1 / factorial;
+        factorial *= i + 1;
+    }
+    return FixedPolynomial<double, N>(c);
+}
+
+static_assert(taylorExp<8>()(0.0) == 1.0 && taylorExp<2>()(1.0) == 2.0, "taylorExp");
+
+template <typename T, size_t N>
+void benchFixed(const char * type, const FixedPolynomial<T, N>& fixed, const std::vector<T>& points, const T& scale) {
+    const Polynomial<T> dynamic = fixed;
+    const size_t count = points.size();
+    const size_t repeats = 64;
+    auto report = [&](const char * algorithm, double seconds) {
+        std::cout << "fixed\t" << type << "\t" << N << "\t" << algorithm << "\t" << count / seconds << "\n";
+    };
+
+    T sink = T(0);
+    report("single_horner", measureSeconds([&] {
+        for (const auto& x : points)
+            sink += dynamic(x);
+    }, repeats));
+    report("single_horner_fixed", measureSeconds([&] {
+        for (const auto& x : points)
+            sink += hornerFixed(fixed, x);
+    }, repeats));
+    report("single_estrin", measureSeconds([&] {
+        for (const auto& x : points)
+            sink += fixed(x);
+    }, repeats));
+
+    T x = points[0];
+    report("chain_horner_fixed", measureSeconds([&] {
+        for (size_t i = 0; i != count; ++i)
+            x = hornerFixed(fixed, x) * scale;
+    }, repeats));
+    report("chain_estrin", measureSeconds([&] {
+        for (size_t i = 0; i != count; ++i)
+            x = fixed(x) * scale;
+    }, repeats));
+
+    report("batch_horner", measureSeconds([&] {
+        sink += dynamic(points)[0];
+    }, repeats));
+    report("batch_estrin", measureSeconds([&] {
+        sink += fixed(points)[0];
+    }, repeats));
+    keep(sink);
+    keep(x);
+}
+
+void runFixed() {
+    std::cout << "# fixed\ttype\tlength\talgorithm\tpoints/s\n";
+    const size_t count = 1 << 15;
+    auto points = randomCoefficients<double>(count, 1000);
+    for (auto& x : points)
+        x /= 1000;  // exp приближаем на [-1, 1]
+    // Множитель 1/4 держит цепочку x -> exp(x) / 4 внутри отрезка
+    benchFixed<double>("double", taylorExp<8>(), points, 0.25);
+    benchFixed<double>("double", taylorExp<16>(), points, 0.25);
+
+    typedef ModInt<998244353> Z;
+    const auto residues = randomCoefficients<Z>(count, 998244352);
+    constexpr FixedPolynomial<Z, 8> z8{3, 1, 4, 1, 5, 9, 2, 6};
+    constexpr FixedPolynomial<Z, 16> z16{3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9, 3};
+    benchFixed<Z>("mod_998244353", z8, residues, Z(1));
+    benchFixed<Z>("mod_998244353", z16, residues, Z(1));
+}
+
+int main(int argc, char ** argv) {
+    std::string mode = argc > 1 ? argv[1] : "all";
+    if (mode == "thresholds" || mode == "all")
+        runThresholds();
+    if (mode == "large" || mode == "all")
+        runLarge();
+    if (mode == "division" || mode == "all")
+        runDivision();
+    if (mode == "gcd" || mode == "all")
+        runGcd();
+    if (mode == "evaluate" || mode == "all")
+        runEvaluate();
+    if (mode == "multivariate" || mode == "all")
+        runMultivariate();
+    if (mode == "parallel" || mode == "all")
+        runParallel();
+    if (mode == "fraction" || mode == "all")
+        runFraction();
+    if (mode == "properties" || mode == "all")
+        runProperties();
+    if (mode == "fixed" || mode == "all")
+        runFixed();
+}